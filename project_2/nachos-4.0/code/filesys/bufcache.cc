@@ -0,0 +1,368 @@
+// bufcache.cc
+//	Routines to manage the cache of disk sectors.  See bufcache.h
+//	for details.
+//
+//	A lock protects the cache.  It is not held while a sector is
+//	read or written; instead the buffer is marked busy, and anyone
+//	else who wants it waits on the "changed" condition.  So threads
+//	that hit in the cache need not wait for a disk request that
+//	someone else is making.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "bufcache.h"
+#include "synchdisk.h"
+#include "synch.h"
+#include "main.h"
+
+//----------------------------------------------------------------------
+// FlushCache
+//	Dummy function, to start a thread that does the periodic flush.
+//----------------------------------------------------------------------
+
+static void
+FlushCache(BufferCache *cache)
+{
+    cache->PeriodicFlush();
+}
+
+//----------------------------------------------------------------------
+// BufferCache::BufferCache
+//	Initialize a cache with no sectors in it.
+//
+//	"disk" is the disk to cache the sectors of.
+//----------------------------------------------------------------------
+
+BufferCache::BufferCache(SynchDisk *disk)
+{
+    synchDisk = disk;
+    lruList = new DList<CacheBuffer, &CacheBuffer::lruLink>;
+    for (int i = 0; i < CacheSectors; i++) {
+	lruList->Append(&buffers[i]);
+    }
+    for (int i = 0; i < NumSectors; i++) {
+	bySector[i] = NULL;
+    }
+    lock = new Lock("buffer cache");
+    changed = new Condition("buffer cache changed");
+    flushScheduled = FALSE;
+}
+
+//----------------------------------------------------------------------
+// BufferCache::~BufferCache
+//	Write back what is dirty, so nothing is lost as Nachos halts, and
+//	de-allocate the cache.
+//----------------------------------------------------------------------
+
+BufferCache::~BufferCache()
+{
+    Flush();
+    delete lruList;
+    delete changed;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// BufferCache::Pin
+//	Find a sector's buffer, reading the sector in if it is not in
+//	the cache, and keep it there until it is unpinned.
+//
+//	To make room, the least recently used buffer that no one has
+//	pinned is taken; if it is dirty, it is written back first.  If
+//	every buffer is pinned, we wait for one to be unpinned.
+//
+//	On a miss with "overwrite", the buffer still holds whatever
+//	sector it had before, so it is marked not valid: anyone else
+//	pinning the sector waits until our caller has filled it in and
+//	unpinned it.
+//
+// Returns:
+//	The sector's data.  It stays valid until Unpin.
+//
+//	"sector" is the disk sector to pin.
+//	"overwrite" is TRUE if the caller is about to fill in the whole
+//	   sector, so there is no need to read it from disk on a miss.
+//----------------------------------------------------------------------
+
+char *
+BufferCache::Pin(int sector, bool overwrite)
+{
+    CacheBuffer *buffer;
+
+    ASSERT((sector >= 0) && (sector < NumSectors));
+    lock->Acquire();
+    for (;;) {
+	buffer = bySector[sector];
+	if (buffer != NULL) {			// hit
+	    if (buffer->busy || !buffer->valid) {
+		changed->Wait(lock);
+		continue;
+	    }
+	    if (buffer->pinCount++ == 0) {
+		lruList->Remove(buffer);
+	    }
+	    kernel->stats->numCacheHits++;
+	    lock->Release();
+	    return buffer->data;
+	}
+
+	buffer = lruList->Front();		// miss: find a victim
+	while (buffer != NULL && buffer->busy) {
+	    buffer = lruList->Next(buffer);
+	}
+	if (buffer == NULL) {
+	    changed->Wait(lock);		// all pinned, or busy
+	    continue;
+	}
+	if (buffer->dirty) {
+	    WriteBack(buffer);			// lets go of the lock, so
+	    continue;				// look again
+	}
+	break;
+    }
+
+    DEBUG(dbgFile, "Cache miss on sector " << sector << ", replacing "
+	  << buffer->sector);
+    kernel->stats->numCacheMisses++;
+    lruList->Remove(buffer);
+    if (buffer->sector >= 0) {
+	bySector[buffer->sector] = NULL;
+    }
+    buffer->sector = sector;
+    buffer->pinCount = 1;
+    bySector[sector] = buffer;
+    if (overwrite) {
+	buffer->valid = FALSE;
+    } else {
+	buffer->busy = TRUE;
+	lock->Release();
+	synchDisk->ReadSector(sector, buffer->data);
+	lock->Acquire();
+	buffer->busy = FALSE;
+	changed->Broadcast(lock);
+    }
+    lock->Release();
+    return buffer->data;
+}
+
+//----------------------------------------------------------------------
+// BufferCache::Unpin
+//	Let go of a pinned sector.  Once no one has it pinned, its buffer
+//	goes on the end of the LRU list.
+//
+//	The first sector made dirty after a flush starts the clock on the
+//	next one.  A sector pinned to be overwritten becomes valid now,
+//	and those waiting for it can go ahead.
+//
+//	"sector" is the disk sector, pinned by Pin.
+//	"dirty" is TRUE if the caller changed its data.
+//----------------------------------------------------------------------
+
+void
+BufferCache::Unpin(int sector, bool dirty)
+{
+    CacheBuffer *buffer;
+
+    lock->Acquire();
+    buffer = bySector[sector];
+    ASSERT(buffer != NULL && buffer->pinCount > 0);
+    if (!buffer->valid) {
+	ASSERT(dirty);
+	buffer->valid = TRUE;
+	changed->Broadcast(lock);
+    }
+    if (dirty) {
+	buffer->dirty = TRUE;
+
+	IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+	if (!flushScheduled) {
+	    flushScheduled = TRUE;
+	    kernel->interrupt->Schedule(this, CacheFlushDelay, CacheFlushInt);
+	}
+	(void) kernel->interrupt->SetLevel(oldLevel);
+    }
+    if (--buffer->pinCount == 0) {
+	lruList->Append(buffer);
+	changed->Broadcast(lock);
+    }
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// BufferCache::ReadSector
+// 	Copy the contents of a sector into a buffer, reading it from disk
+//	only if it is not already cached.
+//
+//	"sector" -- the disk sector to read
+//	"data" -- the buffer to hold the contents of the disk sector
+//----------------------------------------------------------------------
+
+void
+BufferCache::ReadSector(int sector, char *data)
+{
+    bcopy(Pin(sector), data, SectorSize);
+    Unpin(sector, FALSE);
+}
+
+//----------------------------------------------------------------------
+// BufferCache::WriteSector
+// 	Copy new contents for a whole sector into the cache.  It is
+//	written back to disk later.
+//
+//	"sector" -- the disk sector to be written
+//	"data" -- the new contents of the disk sector
+//----------------------------------------------------------------------
+
+void
+BufferCache::WriteSector(int sector, char *data)
+{
+    bcopy(data, Pin(sector, TRUE), SectorSize);
+    Unpin(sector, TRUE);
+}
+
+//----------------------------------------------------------------------
+// BufferCache::Flush
+//	Write back every sector that is dirty when we start.  Sectors
+//	made dirty while we are at it are left for next time; otherwise
+//	a busy writer could keep us going for ever.
+//
+//	The buffers are all marked busy first, then handed to the disk
+//	together, without waiting for each in turn -- one request for
+//	each run of consecutive sectors -- so the disk queue can sweep
+//	across them in one pass.  Then the disk is asked to put them on
+//	the host's disk, so a flushed sector survives the host crashing.
+//----------------------------------------------------------------------
+
+void
+BufferCache::Flush()
+{
+    int dirty[CacheSectors];
+    int numDirty = 0;
+    CacheBuffer *batch[CacheSectors];
+    char *batchData[CacheSectors];
+    int numBatch = 0;
+    DiskRequest *requests[CacheSectors];
+    int numRequests = 0;
+    CacheBuffer *buffer;
+    int i, j;
+
+    lock->Acquire();
+    for (i = 0; i < NumSectors && numDirty < CacheSectors; i++) {
+	if (bySector[i] != NULL && bySector[i]->dirty) {
+	    dirty[numDirty++] = i;
+	}
+    }
+    for (i = 0; i < numDirty; i++) {
+	while ((buffer = bySector[dirty[i]]) != NULL && buffer->busy) {
+	    changed->Wait(lock);
+	}
+	if (buffer != NULL && buffer->dirty) {
+	    DEBUG(dbgFile, "Cache write-back of sector " << buffer->sector);
+	    buffer->busy = TRUE;
+	    buffer->dirty = FALSE;
+	    batchData[numBatch] = buffer->data;
+	    batch[numBatch++] = buffer;
+	}
+    }
+    lock->Release();
+
+    for (i = 0; i < numBatch; i = j) {
+	for (j = i + 1; j < numBatch &&
+		batch[j]->sector == batch[j - 1]->sector + 1; j++) {
+	}
+	requests[numRequests] = new DiskRequest(batch[i]->sector, j - i,
+						&batchData[i], TRUE);
+	synchDisk->Submit(requests[numRequests++]);
+    }
+    for (i = 0; i < numRequests; i++) {
+	synchDisk->Wait(requests[i]);
+	delete requests[i];
+    }
+    if (numRequests > 0) {
+	synchDisk->Flush();
+    }
+
+    lock->Acquire();
+    for (i = 0; i < numBatch; i++) {
+	batch[i]->busy = FALSE;
+	kernel->stats->numCacheWriteBacks++;
+    }
+    if (numBatch > 0) {
+	changed->Broadcast(lock);
+    }
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// BufferCache::CallBack
+//	Interrupt handler for the periodic flush.  Writing back blocks,
+//	which an interrupt handler may not do, so start a thread to do it.
+//----------------------------------------------------------------------
+
+void
+BufferCache::CallBack()
+{
+    Thread *flusher = new Thread("cache flush");
+
+    flusher->Fork((VoidFunctionPtr) FlushCache, (void *) this);
+}
+
+//----------------------------------------------------------------------
+// BufferCache::PeriodicFlush
+//	Write back every dirty sector, then start the clock on the next
+//	periodic flush if any sector was made dirty meanwhile (behind us).
+//	Until then, sectors made dirty do not start a flush of their own,
+//	so only one flush runs at a time.
+//----------------------------------------------------------------------
+
+void
+BufferCache::PeriodicFlush()
+{
+    bool anyDirty = FALSE;
+    IntStatus oldLevel;
+
+    Flush();
+    lock->Acquire();
+    for (int i = 0; i < CacheSectors; i++) {
+	if (buffers[i].dirty) {
+	    anyDirty = TRUE;
+	}
+    }
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    if (anyDirty) {
+	kernel->interrupt->Schedule(this, CacheFlushDelay, CacheFlushInt);
+    } else {
+	flushScheduled = FALSE;
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// BufferCache::WriteBack
+//	Write a dirty buffer back to disk.  The caller holds the lock;
+//	we let go of it while the disk is busy.  The buffer is clean
+//	from the start, so a change made while it is being written
+//	makes it dirty again.
+//
+//	"buffer" is the buffer to write; it must not be busy.
+//----------------------------------------------------------------------
+
+void
+BufferCache::WriteBack(CacheBuffer *buffer)
+{
+    ASSERT(lock->IsHeldByCurrentThread());
+    ASSERT(!buffer->busy && buffer->dirty);
+    DEBUG(dbgFile, "Cache write-back of sector " << buffer->sector);
+    buffer->busy = TRUE;
+    buffer->dirty = FALSE;
+    lock->Release();
+    synchDisk->WriteSector(buffer->sector, buffer->data);
+    lock->Acquire();
+    buffer->busy = FALSE;
+    kernel->stats->numCacheWriteBacks++;
+    changed->Broadcast(lock);
+}
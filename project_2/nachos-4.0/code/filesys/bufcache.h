@@ -0,0 +1,115 @@
+// bufcache.h
+//	Data structures for a cache of disk sectors, kept in memory
+//	between the file system and the synchronous disk.
+//
+//	Every read of a file, a file header, the directory or the free
+//	map used to go to the disk, even for the same few sectors over
+//	and over (the headers of the free map and the directory, in
+//	sectors 0 and 1, most of all).  The BufferCache keeps the most
+//	recently used sectors in memory instead:
+//
+//	   A sector that is in the cache is read without going to disk.
+//	   A sector that is written is only marked dirty; it is written
+//	     back when its buffer is needed for another sector, or by
+//	     the periodic flush, CacheFlushDelay ticks after the first
+//	     buffer became dirty -- or by Flush, and as Nachos halts.
+//	   When a buffer is needed, the least recently used one that no
+//	     one has pinned is taken.
+//
+//	A caller can either copy a whole sector in or out (ReadSector,
+//	WriteSector, as with SynchDisk), or Pin the sector's buffer and
+//	work on it in place, then Unpin it, saying if it changed the
+//	data.  A pinned buffer is never taken for another sector.
+//
+//	The periodic flush is started by an interrupt, so the machine
+//	does not halt for want of something to do while there is dirty
+//	data in the cache.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef BUFCACHE_H
+#define BUFCACHE_H
+
+#include "copyright.h"
+#include "disk.h"
+#include "dlist.h"
+#include "callback.h"
+
+class SynchDisk;
+class Lock;
+class Condition;
+
+// How many sectors the cache holds.
+const int CacheSectors = 32;
+
+// How long a buffer may stay dirty before the periodic flush writes it
+// back -- several dozen disk requests' worth.
+const int CacheFlushDelay = 100000;
+
+// The following class defines one buffer of the cache: a copy of a
+// disk sector, and what we know about it.
+
+class CacheBuffer {
+  public:
+    CacheBuffer() { sector = -1; pinCount = 0; dirty = busy = FALSE;
+		    valid = TRUE; }
+
+    int sector;			// the sector held, -1 if none
+    int pinCount;		// how many callers have it pinned
+    bool dirty;			// changed since it was read or written?
+    bool busy;			// being read from, or written to, disk?
+    bool valid;			// does data hold the sector yet?  Not
+				// while an overwriting Pin fills it in
+    DLink<CacheBuffer> lruLink;	// place on the LRU list, if unpinned
+    char data[SectorSize];	// the contents of the sector
+};
+
+// The following class defines the cache of disk sectors.
+
+class BufferCache : public CallBackObj {
+  public:
+    BufferCache(SynchDisk *disk);
+				// initialize an empty cache, in front of
+				// "disk"
+    ~BufferCache();		// write back dirty sectors, and
+				// de-allocate the cache
+
+    void ReadSector(int sector, char *data);
+				// copy a sector out of the cache
+    void WriteSector(int sector, char *data);
+				// copy a whole sector into the cache
+
+    char *Pin(int sector, bool overwrite = FALSE);
+				// keep sector in the cache, and return
+				// its data; if overwrite, the caller will
+				// fill in all of it before it unpins,
+				// so don't read it
+    void Unpin(int sector, bool dirty);
+				// done with a pinned sector; dirty if its
+				// data was changed
+
+    void Flush();		// write back every dirty sector
+    void CallBack();		// time for the periodic flush
+    void PeriodicFlush();	// do it, from a thread of its own
+
+  private:
+    SynchDisk *synchDisk;	// where the sectors come from
+    CacheBuffer buffers[CacheSectors];
+    CacheBuffer *bySector[NumSectors];
+				// the buffer holding each sector, if any
+    DList<CacheBuffer, &CacheBuffer::lruLink> *lruList;
+				// unpinned buffers, least recently used
+				// first
+    Lock *lock;			// protects all of the above
+    Condition *changed;		// a buffer stopped being busy, became
+				// valid, or became unpinned
+    bool flushScheduled;	// is a periodic flush pending, or under
+				// way?
+
+    void WriteBack(CacheBuffer *buffer);
+				// write a dirty buffer to disk; lock held
+};
+
+#endif // BUFCACHE_H
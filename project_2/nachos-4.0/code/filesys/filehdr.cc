@@ -3,12 +3,15 @@
 //	would be called the i-node).
 //
 //	The file header is used to locate where on disk the 
-//	file's data is stored.  We implement this as a fixed size
-//	table of pointers -- each entry in the table points to the 
-//	disk sector containing that portion of the file data
-//	(in other words, there are no indirect or doubly indirect 
-//	blocks). The table size is chosen so that the file header
-//	will be just big enough to fit in one disk sector, 
+//	file's data is stored.  We implement this as a list of
+//	extents -- runs of consecutive sectors -- each holding the next
+//	part of the file data.  The first few are in the file header
+//	itself, which is just big enough to fit in one disk sector; the
+//	rest, if there are any, in a chain of extent blocks.
+//
+//	A new file's data is allocated a run at a time, each run as long
+//	as possible, starting just after the file header: so a file is
+//	usually in one extent, on the header's track.
 //
 //      Unlike in a real system, we do not keep track of file permissions, 
 //	ownership, last modification date, etc., in the file header. 
@@ -26,34 +29,141 @@
 #include "debug.h"
 #include "main.h"
 #include "filehdr.h"
+#include "bufcache.h"
+
+SlabCache FileHeader::cache("FileHeader", sizeof(FileHeader));
+
+// An extent block, as it is on disk.  It is a little smaller than a
+// sector, so it is read and written through a sector-sized buffer.
+
+class ExtentBlock {
+  public:
+    int next;				// the next extent block, or -1
+    Extent extents[NumBlockExtents];	// where the next runs of data
+					// blocks are
+};
+
+//----------------------------------------------------------------------
+// MapExtents
+// 	List the sectors in some extents, one after another.
+//
+// Returns:
+//	How many sectors were listed.
+//
+//	"list" is the extents
+//	"count" is how many there are
+//	"map" is where to list their sectors
+//----------------------------------------------------------------------
+
+static int
+MapExtents(Extent *list, int count, int *map)
+{
+    int n = 0;
+
+    for (int i = 0; i < count; i++)
+	for (int j = 0; j < list[i].length; j++)
+	    map[n++] = list[i].start + j;
+    return n;
+}
+
+//----------------------------------------------------------------------
+// FileHeader::~FileHeader
+// 	De-allocate the in-memory table of data sectors.
+//----------------------------------------------------------------------
+
+FileHeader::~FileHeader()
+{
+    delete [] sectorMap;
+}
 
 //----------------------------------------------------------------------
 // FileHeader::Allocate
 // 	Initialize a fresh file header for a newly created file.
-//	Allocate data blocks for the file out of the map of free disk blocks.
+//	Allocate data blocks for the file out of the map of free disk blocks,
+//	in as few runs as we can: each time, the first run after the last
+//	one (or after "goal") that holds the rest of the file, or else
+//	the longest one there is.  Then allocate and write the extent
+//	blocks, if the file is in too many runs to fit in the header.
 //	Return FALSE if there are not enough free blocks to accomodate
 //	the new file.
 //
 //	"freeMap" is the bit map of free disk sectors
-//	"fileSize" is the bit map of free disk sectors
+//	"fileSize" is the number of bytes in the new file
+//	"goal" is where to start looking for space -- the file header's
+//	   own sector, so the data ends up on the same track if it fits
 //----------------------------------------------------------------------
 
 bool
-FileHeader::Allocate(BitMap *freeMap, int fileSize)
+FileHeader::Allocate(BitMap *freeMap, int fileSize, int goal)
 { 
+    int buffer[SectorSize / sizeof(int)];
+    ExtentBlock *block = (ExtentBlock *) buffer;
+    Extent *runs;
+    int *blockSectors;
+    int count, numBlocks, left, length, i, j, k;
+
+    ASSERT(goal >= 0 && goal < NumSectors);
     numBytes = fileSize;
     numSectors  = divRoundUp(fileSize, SectorSize);
     if (freeMap->NumClear() < numSectors)
 	return FALSE;		// not enough space
 
-    for (int i = 0; i < numSectors; i++)
-	dataSectors[i] = freeMap->FindAndSet();
+    runs = new Extent[numSectors + 1];	// at worst, one per sector
+    for (count = 0, left = numSectors; left > 0; count++, left -= length) {
+	runs[count].start = freeMap->FindRun(left, goal, &length);
+	runs[count].length = length;
+	for (i = 0; i < length; i++)
+	    freeMap->Mark(runs[count].start + i);
+	goal = (runs[count].start + length) % NumSectors;
+    }
+    numBlocks = 0;
+    if (count > (int) NumHeaderExtents)
+	numBlocks = divRoundUp(count - NumHeaderExtents, NumBlockExtents);
+    if (freeMap->NumClear() < numBlocks) {	// no room for extent blocks
+	for (i = 0; i < count; i++)
+	    for (j = 0; j < runs[i].length; j++)
+		freeMap->Clear(runs[i].start + j);
+	delete [] runs;
+	return FALSE;
+    }
+
+    numExtents = count;
+    for (i = 0; i < count && i < (int) NumHeaderExtents; i++)
+	extents[i] = runs[i];
+    blockSectors = new int[numBlocks + 1];
+    for (i = 0; i < numBlocks; i++) {
+	blockSectors[i] = freeMap->FindRun(1, goal, &length);
+	freeMap->Mark(blockSectors[i]);
+	goal = (blockSectors[i] + 1) % NumSectors;
+    }
+    extentBlock = (numBlocks > 0) ? blockSectors[0] : -1;
+    for (i = 0, k = NumHeaderExtents; i < numBlocks; i++) {
+	block->next = (i + 1 < numBlocks) ? blockSectors[i + 1] : -1;
+	for (j = 0; j < (int) NumBlockExtents; j++, k++) {
+	    if (k < count) {
+		block->extents[j] = runs[k];
+	    } else {
+		block->extents[j].start = -1;
+		block->extents[j].length = 0;
+	    }
+	}
+	kernel->bufferCache->WriteSector(blockSectors[i], (char *) buffer);
+    }
+
+    delete [] sectorMap;
+    sectorMap = new int[numSectors + 1];
+    (void) MapExtents(runs, count, sectorMap);
+    DEBUG(dbgFile, "Allocated " << numSectors << " sectors in " << count
+	  << " extents, " << numBlocks << " extent blocks");
+    delete [] blockSectors;
+    delete [] runs;
     return TRUE;
 }
 
 //----------------------------------------------------------------------
 // FileHeader::Deallocate
-// 	De-allocate all the space allocated for data blocks for this file.
+// 	De-allocate all the space allocated for data blocks for this file,
+//	and its extent blocks.
 //
 //	"freeMap" is the bit map of free disk sectors
 //----------------------------------------------------------------------
@@ -61,15 +171,26 @@ FileHeader::Allocate(BitMap *freeMap, int fileSize)
 void 
 FileHeader::Deallocate(BitMap *freeMap)
 {
+    int *map = SectorMap();
+    int buffer[SectorSize / sizeof(int)];
+    ExtentBlock *block = (ExtentBlock *) buffer;
+
     for (int i = 0; i < numSectors; i++) {
-	ASSERT(freeMap->Test((int) dataSectors[i]));  // ought to be marked!
-	freeMap->Clear((int) dataSectors[i]);
+	ASSERT(freeMap->Test((int) map[i]));  // ought to be marked!
+	freeMap->Clear((int) map[i]);
+    }
+    for (int sector = extentBlock; sector != -1; sector = block->next) {
+	kernel->bufferCache->ReadSector(sector, (char *) buffer);
+	ASSERT(freeMap->Test(sector));
+	freeMap->Clear(sector);
     }
 }
 
 //----------------------------------------------------------------------
 // FileHeader::FetchFrom
-// 	Fetch contents of file header from disk. 
+// 	Fetch contents of file header from disk.  Only the part of the
+//	header that is kept on disk is read; the table of data sectors is
+//	made from the extents later, if it is needed.
 //
 //	"sector" is the disk sector containing the file header
 //----------------------------------------------------------------------
@@ -77,12 +198,15 @@ FileHeader::Deallocate(BitMap *freeMap)
 void
 FileHeader::FetchFrom(int sector)
 {
-    kernel->synchDisk->ReadSector(sector, (char *)this);
+    delete [] sectorMap;
+    sectorMap = NULL;
+    kernel->bufferCache->ReadSector(sector, (char *)this);
 }
 
 //----------------------------------------------------------------------
 // FileHeader::WriteBack
-// 	Write the modified contents of the file header back to disk. 
+// 	Write the modified contents of the file header back to disk --
+//	just the part that is kept on disk, which fills one sector.
 //
 //	"sector" is the disk sector to contain the file header
 //----------------------------------------------------------------------
@@ -90,7 +214,7 @@ FileHeader::FetchFrom(int sector)
 void
 FileHeader::WriteBack(int sector)
 {
-    kernel->synchDisk->WriteSector(sector, (char *)this); 
+    kernel->bufferCache->WriteSector(sector, (char *)this); 
 }
 
 //----------------------------------------------------------------------
@@ -100,13 +224,50 @@ FileHeader::WriteBack(int sector)
 //	offset in the file) to a physical address (the sector where the
 //	data at the offset is stored).
 //
+//	The sector is looked up in the table of data sectors, which is
+//	only made (and the extent blocks read) once.
+//
 //	"offset" is the location within the file of the byte in question
 //----------------------------------------------------------------------
 
 int
 FileHeader::ByteToSector(int offset)
 {
-    return(dataSectors[offset / SectorSize]);
+    int block = offset / SectorSize;
+
+    ASSERT(block >= 0 && block < numSectors);
+    return SectorMap()[block];
+}
+
+//----------------------------------------------------------------------
+// FileHeader::SectorMap
+// 	Return the table of the disk sectors of all the file's data
+//	blocks, in order.  The first time, make it from the extents,
+//	reading the extent blocks if there are any.
+//----------------------------------------------------------------------
+
+int *
+FileHeader::SectorMap()
+{
+    int buffer[SectorSize / sizeof(int)];
+    ExtentBlock *block = (ExtentBlock *) buffer;
+    int n, left, count;
+
+    if (sectorMap != NULL)
+	return sectorMap;
+
+    sectorMap = new int[numSectors + 1];
+    count = min(numExtents, (int) NumHeaderExtents);
+    n = MapExtents(extents, count, sectorMap);
+    left = numExtents - count;
+    for (int sector = extentBlock; sector != -1; sector = block->next) {
+	kernel->bufferCache->ReadSector(sector, (char *) buffer);
+	count = min(left, (int) NumBlockExtents);
+	n += MapExtents(block->extents, count, &sectorMap[n]);
+	left -= count;
+    }
+    ASSERT(n == numSectors && left == 0);
+    return sectorMap;
 }
 
 //----------------------------------------------------------------------
@@ -130,14 +291,20 @@ void
 FileHeader::Print()
 {
     int i, j, k;
+    int *map = SectorMap();
     char *data = new char[SectorSize];
 
     printf("FileHeader contents.  File size: %d.  File blocks:\n", numBytes);
     for (i = 0; i < numSectors; i++)
-	printf("%d ", dataSectors[i]);
+	printf("%d ", map[i]);
+    printf("\nExtents: %d.", numExtents);
+    for (i = 0; i < numExtents && i < (int) NumHeaderExtents; i++)
+	printf(" %d+%d", extents[i].start, extents[i].length);
+    if (extentBlock != -1)
+	printf(" ... (extent blocks from %d)", extentBlock);
     printf("\nFile contents:\n");
     for (i = k = 0; i < numSectors; i++) {
-	kernel->synchDisk->ReadSector(dataSectors[i], data);
+	kernel->bufferCache->ReadSector(map[i], data);
         for (j = 0; (j < SectorSize) && (k < numBytes); j++, k++) {
 	    if ('\040' <= data[j] && data[j] <= '\176')   // isprint(data[j])
 		printf("%c", data[j]);
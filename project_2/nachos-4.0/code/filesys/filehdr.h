@@ -16,30 +16,56 @@
 
 #include "disk.h"
 #include "bitmap.h"
+#include "slab.h"
 
-#define NumDirect 	((SectorSize - 2 * sizeof(int)) / sizeof(int))
-#define MaxFileSize 	(NumDirect * SectorSize)
+// An extent is a run of consecutive disk sectors holding consecutive
+// blocks of a file.
+
+class Extent {
+  public:
+    int start;				// first sector of the run
+    int length;				// how many sectors in it
+};
+
+#define NumHeaderExtents ((SectorSize - 4 * sizeof(int)) / sizeof(Extent))
+#define NumBlockExtents	((SectorSize - sizeof(int)) / sizeof(Extent))
+#define MaxFileSize 	(NumSectors * SectorSize)
 
 // The following class defines the Nachos "file header" (in UNIX terms,  
 // the "i-node"), describing where on disk to find all of the data in the file.
-// The file header is organized as a simple table of pointers to
-// data blocks. 
+// The file header is organized as a list of extents.  Space for a file
+// is allocated a run at a time, as close after the header as there is
+// room, so most files are in one extent, on the same track as their
+// header, and can be read without seeking.  The first NumHeaderExtents
+// extents are in the header; if a file is in more pieces than that,
+// the rest go in a chain of extent blocks -- sectors holding the number
+// of the next extent block (or -1), then NumBlockExtents more extents.
 //
 // The file header data structure can be stored in memory or on disk.
 // When it is on disk, it is stored in a single sector -- this means
-// that we assume the size of this data structure to be the same
-// as one disk sector.  Without indirect addressing, this
-// limits the maximum file length to just under 4K bytes.
+// that we assume the size of the on-disk part of this data structure
+// to be the same as one disk sector.  A file can be as large as the
+// free space on the disk.
+//
+// In memory, the header also keeps the sector numbers of all of the
+// file's data blocks in one table, made from the extents (read from
+// the extent blocks, if need be) the first time it is needed, so that
+// ByteToSector is a table lookup.
 //
-// There is no constructor; rather the file header can be initialized
-// by allocating blocks for the file (if it is a new file), or by
-// reading it from disk.
+// The file header can be initialized by allocating blocks for the file
+// (if it is a new file), or by reading it from disk.
 
 class FileHeader {
   public:
-    bool Allocate(BitMap *bitMap, int fileSize);// Initialize a file header, 
+    FileHeader() { sectorMap = NULL; }
+    ~FileHeader();			// de-allocate the in-memory table
+
+    bool Allocate(BitMap *bitMap, int fileSize, int goal = 0);
+						// Initialize a file header, 
 						//  including allocating space 
-						//  on disk for the file data
+						//  on disk for the file data,
+						//  from sector goal on if
+						//  possible
     void Deallocate(BitMap *bitMap);  		// De-allocate this file's 
 						//  data blocks
 
@@ -56,11 +82,27 @@ class FileHeader {
 
     void Print();			// Print the contents of the file.
 
+    void *operator new(size_t size) { return cache.Alloc(size); }
+    void operator delete(void *p) { cache.Free(p); }
+    static SlabCache cache;		// headers are allocated for every
+					// file opened, created or removed
+
   private:
+    // These are stored on disk, in this order.
     int numBytes;			// Number of bytes in the file
     int numSectors;			// Number of data sectors in the file
-    int dataSectors[NumDirect];		// Disk sector numbers for each data 
-					// block in the file
+    int numExtents;			// Number of extents the file is in
+    int extentBlock;			// Sector of the first extent block,
+					// or -1 if none
+    Extent extents[NumHeaderExtents];	// Where the first NumHeaderExtents
+					// runs of data blocks are
+
+    // These are only in memory.
+    int *sectorMap;			// Disk sector numbers for every data
+					// block, or NULL if not made yet
+
+    int *SectorMap();			// Return sectorMap, reading the
+					// extent blocks if need be
 };
 
 #endif // FILEHDR_H
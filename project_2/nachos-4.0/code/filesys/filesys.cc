@@ -23,16 +23,21 @@
 //
 //	For those operations (such as Create, Remove) that modify the
 //	directory and/or bitmap, if the operation succeeds, the changes
-//	are written immediately back to disk (the two files are kept
-//	open during all this time).  If the operation fails, and we have
+//	are written immediately back to the files (the two files are kept
+//	open during all this time); the buffer cache gets them to disk
+//	later.  If the operation fails, and we have
 //	modified part of the directory and/or bitmap, we simply discard
 //	the changed version, without writing it back to disk.
 //
 // 	Our implementation at this point has the following restrictions:
 //
-//	   there is no synchronization for concurrent accesses
+//	   the directory and bitmap are protected by a reader-writer
+//	     lock, so many threads can open files at once, but there
+//	     is no synchronization for concurrent accesses to a file
 //	   files have a fixed size, set when the file is created
-//	   files cannot be bigger than about 3KB in size
+//	   files can only be as big as the free space on the disk: the
+//	     header holds the first few extents (runs of sectors), and
+//	     the rest go in a chain of extent blocks (see filehdr.h)
 //	   there is no hierarchical directory structure, and only a limited
 //	     number of files can be added to the system
 //	   there is no attempt to make the system robust to failures
@@ -50,6 +55,7 @@
 #include "directory.h"
 #include "filehdr.h"
 #include "filesys.h"
+#include "synch.h"
 #include "debug.h"
 #include "pbitmap.h"
 
@@ -82,6 +88,7 @@
 FileSystem::FileSystem(bool format)
 { 
     DEBUG(dbgFile, "Initializing the file system.");
+    metaLock = new ReaderWriterLock("file system metadata");
     if (format) {
         PersistBitMap *freeMap = new PersistBitMap(NumSectors);
         Directory *directory = new Directory(NumDirEntries);
@@ -98,8 +105,8 @@ FileSystem::FileSystem(bool format)
     // Second, allocate space for the data blocks containing the contents
     // of the directory and bitmap files.  There better be enough space!
 
-	ASSERT(mapHdr->Allocate(freeMap, FreeMapFileSize));
-	ASSERT(dirHdr->Allocate(freeMap, DirectoryFileSize));
+	ASSERT(mapHdr->Allocate(freeMap, FreeMapFileSize, FreeMapSector));
+	ASSERT(dirHdr->Allocate(freeMap, DirectoryFileSize, DirectorySector));
 
     // Flush the bitmap and directory FileHeaders back to disk
     // We need to do this before we can "Open" the file, since open
@@ -183,6 +190,7 @@ FileSystem::Create(char *name, int initialSize)
 
     DEBUG(dbgFile, "Creating file " << name << " size " << initialSize);
 
+    metaLock->AcquireWrite();
     directory = new Directory(NumDirEntries);
     directory->FetchFrom(directoryFile);
 
@@ -198,7 +206,7 @@ FileSystem::Create(char *name, int initialSize)
             success = FALSE;	// no space in directory
 	else {
     	    hdr = new FileHeader;
-	    if (!hdr->Allocate(freeMap, initialSize))
+	    if (!hdr->Allocate(freeMap, initialSize, sector))
             	success = FALSE;	// no space on disk for data
 	    else {	
 	    	success = TRUE;
@@ -212,6 +220,7 @@ FileSystem::Create(char *name, int initialSize)
         delete freeMap;
     }
     delete directory;
+    metaLock->ReleaseWrite();
     return success;
 }
 
@@ -233,10 +242,12 @@ FileSystem::Open(char *name)
     int sector;
 
     DEBUG(dbgFile, "Opening file" << name);
+    metaLock->AcquireRead();
     directory->FetchFrom(directoryFile);
     sector = directory->Find(name); 
     if (sector >= 0) 		
 	openFile = new OpenFile(sector);	// name was found in directory 
+    metaLock->ReleaseRead();
     delete directory;
     return openFile;				// return NULL if not found
 }
@@ -263,11 +274,13 @@ FileSystem::Remove(char *name)
     FileHeader *fileHdr;
     int sector;
     
+    metaLock->AcquireWrite();
     directory = new Directory(NumDirEntries);
     directory->FetchFrom(directoryFile);
     sector = directory->Find(name);
     if (sector == -1) {
        delete directory;
+       metaLock->ReleaseWrite();
        return FALSE;			 // file not found 
     }
     fileHdr = new FileHeader;
@@ -285,6 +298,7 @@ FileSystem::Remove(char *name)
     delete fileHdr;
     delete directory;
     delete freeMap;
+    metaLock->ReleaseWrite();
     return TRUE;
 } 
 
@@ -298,8 +312,10 @@ FileSystem::List()
 {
     Directory *directory = new Directory(NumDirEntries);
 
+    metaLock->AcquireRead();
     directory->FetchFrom(directoryFile);
     directory->List();
+    metaLock->ReleaseRead();
     delete directory;
 }
 
@@ -321,6 +337,7 @@ FileSystem::Print()
     PersistBitMap *freeMap = new PersistBitMap(NumSectors);
     Directory *directory = new Directory(NumDirEntries);
 
+    metaLock->AcquireRead();
     printf("Bit map file header:\n");
     bitHdr->FetchFrom(FreeMapSector);
     bitHdr->Print();
@@ -334,6 +351,7 @@ FileSystem::Print()
 
     directory->FetchFrom(directoryFile);
     directory->Print();
+    metaLock->ReleaseRead();
 
     delete bitHdr;
     delete dirHdr;
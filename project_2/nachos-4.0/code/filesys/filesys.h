@@ -38,6 +38,8 @@
 #include "copyright.h"
 #include "openfile.h"
 
+class ReaderWriterLock;
+
 #ifdef FILESYS_STUB 		// Temporarily implement file system calls as 
 				// calls to UNIX, until the real file system
 				// implementation is available
@@ -90,6 +92,8 @@ class FileSystem {
 					// represented as a file
    OpenFile* directoryFile;		// "Root" directory -- list of 
 					// file names, represented as a file
+   ReaderWriterLock *metaLock;		// held to read the directory, or
+					// to change it and the free map
 };
 
 #endif // FILESYS
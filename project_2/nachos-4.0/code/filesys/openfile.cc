@@ -18,6 +18,7 @@
 #include "openfile.h"
 #include "debug.h"
 #include "main.h"
+#include "bufcache.h"
 
 //----------------------------------------------------------------------
 // OpenFile::OpenFile
@@ -95,16 +96,17 @@ OpenFile::Write(char *into, int numBytes)
 //
 //	There is no guarantee the request starts or ends on an even disk sector
 //	boundary; however the disk only knows how to read/write a whole disk
-//	sector at a time.  Thus:
+//	sector at a time.  So we work on each sector's buffer in the
+//	buffer cache, pinning it while we copy:
 //
 //	For ReadAt:
-//	   We read in all of the full or partial sectors that are part of the
-//	   request, but we only copy the part we are interested in.
+//	   We copy out just the part of each sector we are interested in.
 //	For WriteAt:
-//	   We must first read in any sectors that will be partially written,
-//	   so that we don't overwrite the unmodified portion.  We then copy
-//	   in the data that will be modified, and write back all the full
-//	   or partial sectors that are part of the request.
+//	   We copy in the data that will be modified, and mark the sector
+//	   dirty.  A sector that will only be partially written must be
+//	   read in first (by the cache, if it is not there already), so
+//	   that we don't overwrite the unmodified portion; one that will
+//	   be entirely overwritten need not be.
 //
 //	"into" -- the buffer to contain the data to be read from disk 
 //	"from" -- the buffer containing the data to be written to disk 
@@ -117,8 +119,8 @@ int
 OpenFile::ReadAt(char *into, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
-    char *buf;
+    int i, firstSector, lastSector, sector, start, end;
+    char *data;
 
     if ((numBytes <= 0) || (position >= fileLength))
     	return 0; 				// check request
@@ -128,17 +130,17 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
-    numSectors = 1 + lastSector - firstSector;
 
-    // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
-    for (i = firstSector; i <= lastSector; i++)	
-        kernel->synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-
-    // copy the part we want
-    bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete [] buf;
+    // copy the part we want out of each full or partial sector
+    for (i = firstSector; i <= lastSector; i++) {
+	start = max(position, i * SectorSize);
+	end = min(position + numBytes, (i + 1) * SectorSize);
+	sector = hdr->ByteToSector(i * SectorSize);
+	data = kernel->bufferCache->Pin(sector);
+	bcopy(&data[start - i * SectorSize], &into[start - position],
+	      end - start);
+	kernel->bufferCache->Unpin(sector, FALSE);
+    }
     return numBytes;
 }
 
@@ -146,9 +148,8 @@ int
 OpenFile::WriteAt(char *from, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
-    bool firstAligned, lastAligned;
-    char *buf;
+    int i, firstSector, lastSector, sector, start, end;
+    char *data;
 
     if ((numBytes <= 0) || (position >= fileLength))
 	return 0;				// check request
@@ -158,28 +159,18 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
 
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
-    numSectors = 1 + lastSector - firstSector;
-
-    buf = new char[numSectors * SectorSize];
-
-    firstAligned = (position == (firstSector * SectorSize));
-    lastAligned = ((position + numBytes) == ((lastSector + 1) * SectorSize));
-
-// read in first and last sector, if they are to be partially modified
-    if (!firstAligned)
-        ReadAt(buf, SectorSize, firstSector * SectorSize);	
-    if (!lastAligned && ((firstSector != lastSector) || firstAligned))
-        ReadAt(&buf[(lastSector - firstSector) * SectorSize], 
-				SectorSize, lastSector * SectorSize);	
-
-// copy in the bytes we want to change 
-    bcopy(from, &buf[position - (firstSector * SectorSize)], numBytes);
 
-// write modified sectors back
-    for (i = firstSector; i <= lastSector; i++)	
-        kernel->synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-    delete [] buf;
+// copy in the bytes we want to change, sector by sector; the cache
+// reads in the first and last sector if they are partially modified
+    for (i = firstSector; i <= lastSector; i++) {
+	start = max(position, i * SectorSize);
+	end = min(position + numBytes, (i + 1) * SectorSize);
+	sector = hdr->ByteToSector(i * SectorSize);
+	data = kernel->bufferCache->Pin(sector, end - start == SectorSize);
+	bcopy(&from[start - position], &data[start - i * SectorSize],
+	      end - start);
+	kernel->bufferCache->Unpin(sector, TRUE);
+    }
     return numBytes;
 }
 
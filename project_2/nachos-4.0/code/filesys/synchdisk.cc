@@ -5,10 +5,16 @@
 //	the disk providing a synchronous interface (requests wait until
 //	the request completes).
 //
-//	Use a semaphore to synchronize the interrupt handlers with the
-//	pending requests.  And, because the physical disk can only
-//	handle one operation at a time, use a lock to enforce mutual
-//	exclusion.
+//	Each request has a semaphore of its own, so the interrupt
+//	handler wakes the thread whose request finished.  Because the
+//	physical disk can only handle one operation at a time, requests
+//	that arrive while it is busy wait on a queue, sorted by sector;
+//	the interrupt handler starts the next one.  The queue is shared
+//	with the interrupt handler, so it is protected by turning
+//	interrupts off.
+//
+//	The synchronous routines are built out of the asynchronous ones:
+//	they Submit a request of their own, and Wait for it.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -16,7 +22,87 @@
 
 #include "copyright.h"
 #include "synchdisk.h"
+#include "main.h"
+
+//----------------------------------------------------------------------
+// DiskRequestCompare
+//	Compare two disk requests by sector number, to keep the queue
+//	sorted.  Requests for the same sector stay in the order they
+//	arrived.
+//----------------------------------------------------------------------
+
+static int
+DiskRequestCompare(DiskRequest *x, DiskRequest *y)
+{
+    if (x->sector < y->sector) { return -1; }
+    else if (x->sector > y->sector) { return 1; }
+    else { return 0; }
+}
+
+//----------------------------------------------------------------------
+// DiskRequest::DiskRequest
+//	Initialize a request for one sector, not yet submitted.
+//
+//	"sectorNumber" -- the disk sector to read or write
+//	"buffer" -- where its contents go, or come from
+//	"write" -- TRUE for a write, FALSE for a read
+//	"toCall" -- if not NULL, its CallBack is called (from the disk
+//	   interrupt handler) once the request is done
+//----------------------------------------------------------------------
+
+DiskRequest::DiskRequest(int sectorNumber, char *buffer, bool write,
+			 CallBackObj *toCall)
+{
+    single = buffer;
+    sector = sectorNumber;
+    numSectors = 1;
+    data = &single;
+    writing = write;
+    transferred = 0;
+    finished = FALSE;
+    whenDone = toCall;
+    done = new Semaphore("disk request", 0);
+}
 
+//----------------------------------------------------------------------
+// DiskRequest::DiskRequest
+//	Initialize a scatter-gather request for several consecutive
+//	sectors, not yet submitted.  The array of buffers is not copied;
+//	it must stay around until the request is done.
+//
+//	"firstSector" -- the first disk sector to read or write
+//	"count" -- how many sectors
+//	"buffers" -- buffers[i] is where sector firstSector + i goes, or
+//	   comes from
+//	"write" -- TRUE for a write, FALSE for a read
+//	"toCall" -- if not NULL, its CallBack is called (from the disk
+//	   interrupt handler) once the request is done
+//----------------------------------------------------------------------
+
+DiskRequest::DiskRequest(int firstSector, int count, char **buffers,
+			 bool write, CallBackObj *toCall)
+{
+    single = NULL;
+    sector = firstSector;
+    numSectors = count;
+    data = buffers;
+    writing = write;
+    transferred = 0;
+    finished = FALSE;
+    whenDone = toCall;
+    done = new Semaphore("disk request", 0);
+}
+
+//----------------------------------------------------------------------
+// DiskRequest::~DiskRequest
+//	De-allocate a request.  It must not be waiting for the disk, or
+//	under way: the interrupt handler would still use it.
+//----------------------------------------------------------------------
+
+DiskRequest::~DiskRequest()
+{
+    delete done;
+}
 
 //----------------------------------------------------------------------
 // SynchDisk::SynchDisk
@@ -25,13 +111,15 @@
 //
 //	"name" -- UNIX file name to be used as storage for the disk data
 //	   (usually, "DISK")
+//	"sync" -- if TRUE, each write is on the host's disk before it
+//	   completes, not just once Flush is called
 //----------------------------------------------------------------------
 
-SynchDisk::SynchDisk(char* name)
+SynchDisk::SynchDisk(char* name, bool sync)
 {
-    semaphore = new Semaphore("synch disk", 0);
-    lock = new Lock("synch disk lock");
-    disk = new Disk(name, this);
+    queue = new SortedList<DiskRequest *>(DiskRequestCompare);
+    current = NULL;
+    disk = new Disk(name, this, sync);
 }
 
 //----------------------------------------------------------------------
@@ -43,8 +131,7 @@ SynchDisk::SynchDisk(char* name)
 SynchDisk::~SynchDisk()
 {
     delete disk;
-    delete lock;
-    delete semaphore;
+    delete queue;
 }
 
 //----------------------------------------------------------------------
@@ -59,10 +146,10 @@ SynchDisk::~SynchDisk()
 void
 SynchDisk::ReadSector(int sectorNumber, char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->ReadRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
-    lock->Release();
+    DiskRequest request(sectorNumber, data, FALSE);
+
+    Submit(&request);
+    Wait(&request);
 }
 
 //----------------------------------------------------------------------
@@ -77,20 +164,270 @@ SynchDisk::ReadSector(int sectorNumber, char* data)
 void
 SynchDisk::WriteSector(int sectorNumber, char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->WriteRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
-    lock->Release();
+    DiskRequest request(sectorNumber, data, TRUE);
+
+    Submit(&request);
+    Wait(&request);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::ReadSectors
+// 	Read several consecutive sectors, each into a buffer of its own.
+//	Return only after all of them have been read.
+//
+//	"firstSector" -- the first disk sector to read
+//	"count" -- how many sectors
+//	"buffers" -- buffers[i] is to hold sector firstSector + i
+//----------------------------------------------------------------------
+
+void
+SynchDisk::ReadSectors(int firstSector, int count, char **buffers)
+{
+    DiskRequest request(firstSector, count, buffers, FALSE);
+
+    Submit(&request);
+    Wait(&request);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WriteSectors
+// 	Write several consecutive sectors, each from a buffer of its own.
+//	Return only after all of them have been written.
+//
+//	"firstSector" -- the first disk sector to write
+//	"count" -- how many sectors
+//	"buffers" -- buffers[i] holds the new contents of sector
+//	   firstSector + i
+//----------------------------------------------------------------------
+
+void
+SynchDisk::WriteSectors(int firstSector, int count, char **buffers)
+{
+    DiskRequest request(firstSector, count, buffers, TRUE);
+
+    Submit(&request);
+    Wait(&request);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Submit
+// 	Queue a request for the disk, starting it right away if the
+//	disk is idle, and return without waiting for it.  The caller
+//	finds out that it is done by polling request->IsDone(), by
+//	calling Wait, or through request->whenDone.
+//
+//	The queue depth a request sees as it arrives, counting itself
+//	and the request in progress, is added up for the statistics.
+//
+//	"request" -- what to read or write; it belongs to the disk until
+//	   it is done
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Submit(DiskRequest *request)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    ASSERT((request->sector >= 0) && (request->numSectors > 0) &&
+	   (request->sector + request->numSectors <= NumSectors));
+    ASSERT(!request->finished && request->transferred == 0);
+    queue->Insert(request);
+    kernel->stats->numDiskQueued++;
+    kernel->stats->diskQueueDepth += queue->NumInList()
+					+ (current != NULL ? 1 : 0);
+    if (current == NULL) {
+	StartNext();
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Wait
+// 	Wait until a submitted request is done.  Returns at once if it
+//	already is.  Only one thread may wait for a given request, once.
+//
+//	"request" -- a request passed to Submit
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Wait(DiskRequest *request)
+{
+    request->done->P();			// wait for interrupt
+    ASSERT(request->finished);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::StartNext
+// 	Send the next queued request to the disk, if there is one.  In
+//	C-LOOK order, that is the first request (by sector) strictly past
+//	the head; if there is none, the head goes back to the lowest
+//	sector anyone wants.  A request for the sector under the head,
+//	or behind it on the same track, waits for the next sweep, so a
+//	steady stream of them cannot hold the head in one place.
+//
+//	Called with interrupts off, while the disk is idle.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::StartNext()
+{
+    ListIterator<DiskRequest *> iter(queue);
+    int head = disk->HeadSector();
+    int rotation;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    ASSERT(current == NULL);
+    if (queue->IsEmpty()) {
+	return;
+    }
+    current = queue->Front();
+    for (; !iter.IsDone(); iter.Next()) {
+	if (iter.Item()->sector > head) {
+	    current = iter.Item();
+	    break;
+	}
+    }
+    queue->Remove(current);
+
+    kernel->stats->diskSeekTracks +=
+		disk->TimeToSeek(current->sector, &rotation) / SeekTime;
+    DEBUG(dbgDisk, "Disk queue: starting sector " << current->sector
+	  << " (" << current->numSectors << " sectors), head at "
+	  << disk->HeadSector() << ", " << queue->NumInList()
+	  << " still queued");
+    StartSector();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::StartSector
+// 	Send the next sector of the current request to the disk.
+//
+//	Called with interrupts off, while the disk is idle.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::StartSector()
+{
+    int sectorNumber = current->sector + current->transferred;
+    char *buffer = current->data[current->transferred];
+
+    if (current->writing) {
+	disk->WriteRequest(sectorNumber, buffer);
+    } else {
+	disk->ReadRequest(sectorNumber, buffer);
+    }
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::CallBack
-// 	Disk interrupt handler.  Wake up any thread waiting for the disk
-//	request to finish.
+// 	Disk interrupt handler.  Go on to the current request's next
+//	sector; or, if that was its last, start the next request, and
+//	let whoever is waiting for this one know it is done.
+//
+//	The next request is started first, since a request's whenDone
+//	may submit another one, or the request may be de-allocated as
+//	soon as it is marked done.
 //----------------------------------------------------------------------
 
 void
 SynchDisk::CallBack()
 { 
-    semaphore->V();
+    DiskRequest *finished = current;
+    CallBackObj *whenDone;
+
+    ASSERT(finished != NULL);
+    if (++finished->transferred < finished->numSectors) {
+	StartSector();
+	return;
+    }
+    current = NULL;
+    StartNext();
+
+    whenDone = finished->whenDone;
+    finished->finished = TRUE;
+    finished->done->V();
+    if (whenDone != NULL) {
+	whenDone->CallBack();
+    }
+}
+
+//----------------------------------------------------------------------
+// DiskOrder
+//	Notes, for SynchDisk::SelfTest, the order in which the disk
+//	finishes requests.
+//----------------------------------------------------------------------
+
+static int serviceOrder[5];
+static int numServiced;
+
+class DiskOrder : public CallBackObj {
+  public:
+    DiskOrder(int sectorNumber) { sector = sectorNumber; }
+    void CallBack() { serviceOrder[numServiced++] = sector; }
+
+  private:
+    int sector;
+};
+
+//----------------------------------------------------------------------
+// DiskReader
+//	One of SynchDisk::SelfTest's threads: read a sector, waiting for
+//	the disk, then say we are done.
+//
+//	"which" is the sector to read
+//----------------------------------------------------------------------
+
+static SynchDisk *testDisk;
+static Semaphore *readersDone;
+
+static void
+DiskReader(int which)
+{
+    char data[SectorSize];
+    DiskOrder order(which);
+    DiskRequest request(which, data, FALSE, &order);
+
+    testDisk->Submit(&request);
+    testDisk->Wait(&request);
+    readersDone->V();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::SelfTest
+//	Check that queued requests are served in C-LOOK order.  While
+//	the disk reads sector 41, threads ask for sectors 40, 5, 70 and
+//	45.  The head goes on to 45 and 70, then back to 5 and 40: 40 is
+//	on the head's track, but behind it, so it waits for the next
+//	sweep.  Only reads, so the contents of the disk are not changed.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::SelfTest()
+{
+    static int sectors[] = { 40, 5, 70, 45 };
+    static int expected[] = { 41, 45, 70, 5, 40 };
+    char data[SectorSize];
+    DiskOrder order(41);
+    DiskRequest first(41, data, FALSE, &order);
+    int i;
+
+    numServiced = 0;
+    testDisk = this;
+    readersDone = new Semaphore("disk readers", 0);
+    Submit(&first);
+    for (i = 0; i < 4; i++) {
+	Thread *t = new Thread("disk reader");
+
+	t->Fork((VoidFunctionPtr) DiskReader, (void *) sectors[i]);
+    }
+    for (i = 0; i < 4; i++) {
+	readersDone->P();
+    }
+    Wait(&first);
+    delete readersDone;
+
+    ASSERT(numServiced == 5);
+    for (i = 0; i < 5; i++) {
+	ASSERT(serviceOrder[i] == expected[i]);
+    }
 }
@@ -13,6 +13,7 @@
 #include "disk.h"
 #include "synch.h"
 #include "callback.h"
+#include "list.h"
 
 // The following class defines a "synchronous" disk abstraction.
 // As with other I/O devices, the raw physical disk is an asynchronous device --
@@ -24,12 +25,62 @@
 // This class provides the abstraction that for any individual thread
 // making a request, it waits around until the operation finishes before
 // returning.
+//
+// Many threads may make requests at once.  Those that arrive while the
+// disk is busy are queued, and each time a request finishes the next
+// one is chosen in C-LOOK order: the head sweeps from the lowest track
+// to the highest, serving each queued request on its way, then goes
+// straight back to the lowest track wanted and starts over.  So the
+// head never crosses the disk more than twice per sweep, and no request
+// waits for more than one sweep.
+//
+// A thread that has other things to do while the disk works can also
+// Submit a request and carry on.  Submit returns at once; the request
+// is the handle, which can be polled (IsDone), waited for (Wait), or
+// can call a CallBackObj when it is done.  A request may cover several
+// consecutive sectors, each with a buffer of its own (scatter-gather);
+// they are done one after another, with no other request in between.
+
 class Semaphore;
-class Lock;
+
+// A request for one or more consecutive sectors, queued until the disk
+// gets to it.
+
+class DiskRequest {
+  public:
+    DiskRequest(int sectorNumber, char *buffer, bool write,
+		CallBackObj *toCall = NULL);
+					// one sector, to or from buffer
+    DiskRequest(int firstSector, int count, char **buffers, bool write,
+		CallBackObj *toCall = NULL);
+					// count sectors, sector i to or from
+					// buffers[i]
+    ~DiskRequest();			// de-allocate a request; it must not
+					// be queued, or in progress
+
+    bool IsDone() { return finished; }	// are all its sectors read/written?
+
+    int sector;				// the first sector to read or write
+    int numSectors;			// how many sectors
+    char **data;			// where each one's data goes, or
+					// comes from
+    bool writing;			// a write, or a read?
+    int transferred;			// how many sectors are done
+    bool finished;			// all of them?
+    CallBackObj *whenDone;		// called once it is done, if not NULL
+    Semaphore *done;			// Wait waits here
+
+  private:
+    char *single;			// the buffer, for a one sector request
+};
+
 class SynchDisk : public CallBackObj {
   public:
-    SynchDisk(char* name);    		// Initialize a synchronous disk,
-					// by initializing the raw Disk.
+    SynchDisk(char* name, bool sync = FALSE);
+					// Initialize a synchronous disk,
+					// by initializing the raw Disk; if
+					// sync, each write is put on the
+					// host's disk as it is done
     ~SynchDisk();			// De-allocate the synch disk data
     
     void ReadSector(int sectorNumber, char* data);
@@ -39,17 +90,37 @@ class SynchDisk : public CallBackObj {
     					// Disk::ReadRequest/WriteRequest and
 					// then wait until the request is done.
     void WriteSector(int sectorNumber, char* data);
+    void ReadSectors(int firstSector, int count, char **buffers);
+    void WriteSectors(int firstSector, int count, char **buffers);
+					// The same, for count consecutive
+					// sectors, with a buffer for each
+
+    void Submit(DiskRequest *request);	// Queue a request, and return
+					// without waiting for it
+    void Wait(DiskRequest *request);	// Wait for a submitted request to
+					// be done; only one thread may wait
+
+    void Flush() { disk->Flush(); }	// Put the sectors written so far
+					// on the host's disk
     
     void CallBack();			// Called by the disk device interrupt
 					// handler, to signal that the
 					// current disk operation is complete.
 
+    void SelfTest();			// Test that requests are served in
+					// C-LOOK order
+
   private:
     Disk *disk;		  		// Raw disk device
-    Semaphore *semaphore; 		// To synchronize requesting thread 
-					// with the interrupt handler
-    Lock *lock;		  		// Only one read/write request
-					// can be sent to the disk at a time
+    SortedList<DiskRequest *> *queue;	// Requests waiting for the disk,
+					// by first sector number
+    DiskRequest *current;		// The request the disk is doing,
+					// or NULL if it is idle
+
+    void StartNext();			// Send the next queued request in
+					// C-LOOK order to the disk
+    void StartSector();			// Send the current request's next
+					// sector to the disk
 };
 
 #endif // SYNCHDISK_H
@@ -138,6 +138,57 @@ BitMap::NumClear() const
     return count;
 }
 
+//----------------------------------------------------------------------
+// BitMap::FindRun
+// 	Find a run of consecutive clear bits -- for instance, free disk
+//	sectors to put part of a file in, one after another.
+//
+//	The runs are looked at in order, starting at "goal" and going
+//	to the end of the bitmap, then from the beginning to "goal".
+//	The first run of at least "count" clear bits is chosen; if there
+//	is none, the longest run (the first of them, if there is a tie).
+//	The bits are not set.
+//
+//	Return the number of the first bit in the run, and set "*length"
+//	to the number of bits in it (no more than "count"), or return -1
+//	if no bits are clear.
+//
+//	"count" is how many clear bits are wanted.
+//	"goal" is where to start looking.
+//	"length" is where to return the length of the run.
+//----------------------------------------------------------------------
+
+int
+BitMap::FindRun(int count, int goal, int *length) const
+{
+    int best = -1, bestLength = 0;
+    int i, end, start;
+
+    ASSERT(count > 0 && goal >= 0 && goal < numBits);
+    for (int pass = 0; pass < 2; pass++) {
+	i = (pass == 0) ? goal : 0;
+	end = (pass == 0) ? numBits : goal;
+	while (i < end) {
+	    if (Test(i)) {
+		i++;
+		continue;
+	    }
+	    for (start = i; i < numBits && !Test(i) && i - start < count; i++)
+		;
+	    if (i - start == count) {
+		*length = count;
+		return start;
+	    }
+	    if (i - start > bestLength) {
+		best = start;
+		bestLength = i - start;
+	    }
+	}
+    }
+    *length = bestLength;
+    return best;
+}
+
 //----------------------------------------------------------------------
 // BitMap::Print
 // 	Print the contents of the bitmap, for debugging.
@@ -177,6 +228,17 @@ BitMap::SelfTest()
     ASSERT(Test(0) && Test(31));
 
     ASSERT(FindAndSet() == 1);
+
+    int length;				// only 2..30 is clear
+    for (i = 32; i < numBits; i++) {
+        Mark(i);
+    }
+    ASSERT(FindRun(4, 0, &length) == 2 && length == 4);
+    ASSERT(FindRun(4, 5, &length) == 5 && length == 4);
+    ASSERT(FindRun(30, 10, &length) == 2 && length == 29);
+    for (i = 32; i < numBits; i++) {
+        Clear(i);
+    }
     Clear(0);
     Clear(1);
     Clear(31);
@@ -43,6 +43,11 @@ class BitMap {
 				// effect, set the bit. 
 				// If no bits are clear, return -1.
     int NumClear() const;	// Return the number of clear bits
+    int FindRun(int count, int goal, int *length) const;
+				// Return the first bit of a run of up to
+				// "count" clear bits, at or after "goal"
+				// if possible, and its length; -1 if no
+				// bits are clear.  Does not set them.
 
     void Print() const;		// Print contents of bitmap
     void SelfTest();		// Test whether bitmap is working
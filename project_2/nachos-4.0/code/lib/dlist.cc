@@ -0,0 +1,192 @@
+// dlist.cc
+//     	Routines to manage an intrusive doubly linked list of "things".
+//	See dlist.h for details.
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+//----------------------------------------------------------------------
+// DList<T, Link>::DList
+//	Initialize a list, empty to start with.
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+DList<T, Link>::DList()
+{
+    first = last = NULL;
+    numInList = 0;
+}
+
+//----------------------------------------------------------------------
+// DList<T, Link>::~DList
+//	Prepare a list for deallocation.  The items on it are not ours
+//	to de-allocate, but they are taken off, so that none is left
+//	pointing at a list that is gone.  (When Nachos halts, threads
+//	may still be on the ready list, or waiting on a semaphore.)
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+DList<T, Link>::~DList()
+{
+    while (RemoveFront() != NULL) {
+	;
+    }
+}
+
+//----------------------------------------------------------------------
+// DList<T, Link>::Append
+//      Put an "item" on the end of the list.  It must not be on any
+//	list already.
+//
+//	"item" is the thing to put on the list.
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+void
+DList<T, Link>::Append(T *item)
+{
+    DLink<T> *link = &(item->*Link);
+
+    ASSERT(!link->IsLinked());
+    link->next = NULL;
+    link->prev = last;
+    link->list = this;
+    if (last == NULL) {
+	first = item;
+    } else {
+	(last->*Link).next = item;
+    }
+    last = item;
+    numInList++;
+}
+
+//----------------------------------------------------------------------
+// DList<T, Link>::Prepend
+//      Put an "item" on the front of the list.  It must not be on any
+//	list already.
+//
+//	"item" is the thing to put on the list.
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+void
+DList<T, Link>::Prepend(T *item)
+{
+    DLink<T> *link = &(item->*Link);
+
+    ASSERT(!link->IsLinked());
+    link->next = first;
+    link->prev = NULL;
+    link->list = this;
+    if (first == NULL) {
+	last = item;
+    } else {
+	(first->*Link).prev = item;
+    }
+    first = item;
+    numInList++;
+}
+
+//----------------------------------------------------------------------
+// DList<T, Link>::RemoveFront
+//      Remove the first "item" from the front of the list.
+//
+// Returns:
+//	The removed item, or NULL if the list is empty.
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+T *
+DList<T, Link>::RemoveFront()
+{
+    T *item = first;
+
+    if (item != NULL) {
+	Remove(item);
+    }
+    return item;
+}
+
+//----------------------------------------------------------------------
+// DList<T, Link>::Remove
+//      Take "item" off the list, in O(1) steps.  It must be on this
+//	list.
+//
+//	"item" is the thing to take off the list.
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+void
+DList<T, Link>::Remove(T *item)
+{
+    DLink<T> *link = &(item->*Link);
+
+    ASSERT(IsInList(item));
+    if (link->prev == NULL) {
+	first = link->next;
+    } else {
+	(link->prev->*Link).next = link->next;
+    }
+    if (link->next == NULL) {
+	last = link->prev;
+    } else {
+	(link->next->*Link).prev = link->prev;
+    }
+    link->next = link->prev = NULL;
+    link->list = NULL;
+    numInList--;
+}
+
+//----------------------------------------------------------------------
+// DList<T, Link>::Splice
+//      Move every item on "other" to the end of this list, keeping
+//	their order, and leave "other" empty.  The two chains are joined
+//	in one step; the only per-item work is to note which list each
+//	item is now on.
+//
+//	"other" is the list to empty into this one.
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+void
+DList<T, Link>::Splice(DList<T, Link> *other)
+{
+    ASSERT(other != this);
+    if (other->IsEmpty()) {
+	return;
+    }
+    for (T *item = other->first; item != NULL; item = (item->*Link).next) {
+	(item->*Link).list = this;
+    }
+    (other->first->*Link).prev = last;
+    if (last == NULL) {
+	first = other->first;
+    } else {
+	(last->*Link).next = other->first;
+    }
+    last = other->last;
+    numInList += other->numInList;
+    other->first = other->last = NULL;
+    other->numInList = 0;
+}
+
+//----------------------------------------------------------------------
+// DList<T, Link>::Apply
+//      Apply a function to each item on the list, in order.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+template <class T, DLink<T> T::*Link>
+void
+DList<T, Link>::Apply(void (*func)(T *))
+{
+    for (T *item = first; item != NULL; item = (item->*Link).next) {
+	(*func)(item);
+    }
+}
@@ -0,0 +1,85 @@
+// dlist.h
+//	Data structures to manage an "intrusive" doubly linked list: the
+//	links are kept in the objects on the list, rather than in a
+//	ListElement allocated for each one.
+//
+//	Compared to a List, putting an object on a DList or taking it off
+//	never allocates memory, and an object can be taken off from the
+//	middle of the list in O(1) steps, without a walk to find it.  The
+//	price is that each object has one DLink per list it may be on at
+//	a time; a Thread, for instance, is on at most one ready queue or
+//	wait queue at once, so one link does for all of them.
+//
+//	A DList is named by the type of its objects and the member that
+//	holds their link, as in
+//
+//		DList<Thread, &Thread::queueLink> *queue;
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef DLIST_H
+#define DLIST_H
+
+#include "copyright.h"
+#include "debug.h"
+
+// The following class defines the link embedded in each object that
+// can be put on a DList.  Only a DList should touch it.
+
+template <class T>
+class DLink {
+  public:
+    DLink() { next = prev = NULL; list = NULL; }
+				// initialize a link, not on any list
+
+    bool IsLinked() { return list != NULL; }
+				// is the object on some list?
+
+    T *next;			// next object on the list, NULL if last
+    T *prev;			// previous object, NULL if first
+    void *list;			// the DList we are on, NULL if none
+};
+
+// The following class defines a doubly linked list of objects of type
+// T, linked through their member "Link".  The list does not own the
+// objects; it is up to the caller to de-allocate them.
+
+template <class T, DLink<T> T::*Link>
+class DList {
+  public:
+    DList();			// initialize the list
+    ~DList();			// de-allocate the list
+
+    void Append(T *item);	// put item at the end of the list
+    void Prepend(T *item);	// put item at the beginning of the list
+    T *RemoveFront();		// take item off the front of the list;
+				// NULL if the list is empty
+    void Remove(T *item);	// take item off the list, wherever it is
+    void Splice(DList<T, Link> *other);
+				// move all of other's items to the end
+				// of this list, in order
+
+    T *Front() { return first; }
+				// first item on the list, NULL if empty
+    T *Next(T *item) { return (item->*Link).next; }
+				// item after this one, NULL if last
+    bool IsInList(T *item) { return (item->*Link).list == this; }
+				// is the item on this list?
+    bool IsEmpty() { return numInList == 0; }
+    int NumInList() { return numInList; }
+
+    void Apply(void (*func)(T *));
+				// apply function to all elements in list
+
+  private:
+    T *first;			// head of the list, NULL if empty
+    T *last;			// last item on the list
+    int numInList;		// number of items on the list
+};
+
+#include "dlist.cc"		// templates are really like macros
+				// so needs to be included in every
+				// file that uses the template
+#endif // DLIST_H
@@ -0,0 +1,293 @@
+// heap.cc
+//     	Routines to manage a priority queue of "things", kept as a
+//	binary min-heap in an array.  See heap.h for details.
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+//----------------------------------------------------------------------
+// Heap<T>::Heap
+//	Initialize a heap, empty to start with.
+//
+//	"comp" is the function used to order the items.
+//	"initialSize" is how many items fit before the array must grow.
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::Heap(int (*comp)(T x, T y), int initialSize)
+{
+    ASSERT(initialSize > 0);
+    compare = comp;
+    size = initialSize;
+    items = new T[size];
+    numInHeap = 0;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::~Heap
+//	Prepare a heap for deallocation.  The items left on it are not
+//	ours to de-allocate, and nothing in them points back at the heap,
+//	so they are simply forgotten.  (When Nachos halts, threads may
+//	still be ready to run.)
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::~Heap()
+{
+    delete [] items;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Insert
+//      Put an "item" on the heap: add it at the bottom, then move it
+//	up past any parent that is larger.
+//
+//	"item" is the thing to put on the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Insert(T item)
+{
+    if (numInHeap == size) {
+	Grow();
+    }
+    items[numInHeap] = item;
+    SiftUp(numInHeap);
+    numInHeap++;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::RemoveFront
+//      Remove the smallest item from the heap: replace it with the
+//	bottom item, then move that down to where it belongs.
+//
+// Returns:
+//	The removed item.
+//----------------------------------------------------------------------
+
+template <class T>
+T
+Heap<T>::RemoveFront()
+{
+    T thing;
+
+    ASSERT(!IsEmpty());
+    thing = items[0];
+    numInHeap--;
+    if (numInHeap > 0) {
+	items[0] = items[numInHeap];
+	SiftDown(0);
+    }
+    return thing;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Remove
+//      Remove a specific item from the heap.  Finding the item takes
+//	a linear search; putting the heap back in order is O(log n).
+//
+//	"item" is the thing to remove from the heap; it must be there.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Remove(T item)
+{
+    int i;
+
+    for (i = 0; i < numInHeap; i++) {
+	if (items[i] == item) {
+	    break;
+	}
+    }
+    ASSERT(i < numInHeap);	// item must be on the heap
+    RemoveAt(i);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::RemoveAt
+//      Remove the i'th item of the heap, in the order used by Item:
+//	replace it with the bottom item, then move that up or down to
+//	where it belongs.  O(log n).
+//
+//	"i" is the position of the item to remove.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::RemoveAt(int i)
+{
+    ASSERT(i >= 0 && i < numInHeap);
+
+    numInHeap--;
+    if (i < numInHeap) {
+	items[i] = items[numInHeap];
+	SiftUp(i);
+	SiftDown(i);
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::IsInHeap
+//      Return TRUE if the item is on the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+bool
+Heap<T>::IsInHeap(T item) const
+{
+    for (int i = 0; i < numInHeap; i++) {
+	if (items[i] == item) {
+	    return TRUE;
+	}
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Apply
+//      Apply function to every item on the heap, in array order.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Apply(void (*func)(T)) const
+{
+    for (int i = 0; i < numInHeap; i++) {
+	(*func)(items[i]);
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SiftUp
+//      Swap items[i] with its parent, for as long as it is smaller
+//	than the parent.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SiftUp(int i)
+{
+    T thing = items[i];
+    int parent;
+
+    while (i > 0) {
+	parent = (i - 1) / 2;
+	if (compare(thing, items[parent]) >= 0) {
+	    break;
+	}
+	items[i] = items[parent];
+	i = parent;
+    }
+    items[i] = thing;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SiftDown
+//      Swap items[i] with its smaller child, for as long as that child
+//	is smaller than it.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SiftDown(int i)
+{
+    T thing = items[i];
+    int child;
+
+    while ((child = 2 * i + 1) < numInHeap) {
+	if (child + 1 < numInHeap
+		&& compare(items[child + 1], items[child]) < 0) {
+	    child++;
+	}
+	if (compare(items[child], thing) >= 0) {
+	    break;
+	}
+	items[i] = items[child];
+	i = child;
+    }
+    items[i] = thing;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Grow
+//      Double the size of the array holding the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Grow()
+{
+    T *bigger = new T[2 * size];
+
+    for (int i = 0; i < numInHeap; i++) {
+	bigger[i] = items[i];
+    }
+    delete [] items;
+    items = bigger;
+    size *= 2;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SanityCheck
+//      Test whether this is still a legal heap: no item is smaller
+//	than its parent.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SanityCheck() const
+{
+    ASSERT(numInHeap >= 0 && numInHeap <= size);
+    for (int i = 1; i < numInHeap; i++) {
+	ASSERT(compare(items[(i - 1) / 2], items[i]) <= 0);
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SelfTest
+//      Test whether this module is working.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SelfTest(T *p, int numEntries)
+{
+    int i;
+    T *q = new T[numEntries];
+
+    SanityCheck();
+    ASSERT(IsEmpty());
+
+    for (i = 0; i < numEntries; i++) {
+	Insert(p[i]);
+	ASSERT(IsInHeap(p[i]));
+	ASSERT(!IsEmpty());
+    }
+    SanityCheck();
+
+    // removing from the middle should leave a legal heap
+    Remove(p[0]);
+    ASSERT(NumInHeap() == numEntries - 1);
+    SanityCheck();
+    Insert(p[0]);
+
+    // should be able to get out everything we put in, smallest first
+    for (i = 0; i < numEntries; i++) {
+	q[i] = RemoveFront();
+	SanityCheck();
+    }
+    ASSERT(IsEmpty());
+    for (i = 0; i < (numEntries - 1); i++) {
+	ASSERT(compare(q[i], q[i + 1]) <= 0);
+    }
+    delete [] q;
+}
@@ -0,0 +1,77 @@
+// heap.h
+//	Data structures to manage a priority queue, kept as a binary
+//	min-heap in an array.
+//
+//	Like a SortedList, a Heap always gives back its smallest item
+//	first, but inserting and removing take O(log n) steps rather than
+//	a walk down the list, and no memory is allocated per item.  The
+//	array grows (doubles) when it is full.
+//
+//	Items with equal keys do not necessarily come out in the order
+//	they went in.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "copyright.h"
+#include "debug.h"
+
+// The following class defines a "heap".  All types to be put on a
+// heap must have a "Compare" function defined, as for a SortedList:
+//	   int Compare(T x, T y)
+//		returns -1 if x < y
+//		returns 0 if x == y
+//		returns 1 if x > y
+
+template <class T>
+class Heap {
+  public:
+    Heap(int (*comp)(T x, T y), int initialSize = 16);
+				// initialize the heap
+    ~Heap();			// de-allocate the heap
+
+    void Insert(T item);	// put an item on the heap
+    T Front() { ASSERT(!IsEmpty()); return items[0]; }
+				// return the smallest item,
+				// without removing it
+    T RemoveFront();		// take the smallest item off the heap
+    void Remove(T item);	// remove a specific item from the heap
+    void RemoveAt(int i);	// remove the i'th item (see Item)
+
+    bool IsInHeap(T item) const;// is the item on the heap?
+    T Item(int i) { ASSERT(i >= 0 && i < numInHeap); return items[i]; }
+				// the i'th item, in no particular
+				// order, for looking through the heap
+    int NumInHeap() { return numInHeap; }
+				// how many items on the heap?
+    bool IsEmpty() { return (numInHeap == 0); }
+				// is the heap empty?
+
+    void Apply(void (*f)(T)) const;
+				// apply function to all items, in
+				// no particular order
+
+    void SanityCheck() const;	// has this heap been corrupted?
+    void SelfTest(T *p, int numEntries);
+				// verify module is working
+
+  private:
+    T *items;			// items[0] is the smallest; the children
+				// of items[i] are items[2i+1], items[2i+2]
+    int size;			// how many items fit in the array
+    int numInHeap;		// how many are there now
+    int (*compare)(T x, T y);	// function for ordering the items
+
+    void SiftUp(int i);		// move items[i] up to where it belongs
+    void SiftDown(int i);	// move items[i] down to where it belongs
+    void Grow();		// double the size of the array
+};
+
+#include "heap.cc"		// templates are really like macros
+				// so needs to be included in every
+				// file that uses the template
+#endif // HEAP_H
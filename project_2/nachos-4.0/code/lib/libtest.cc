@@ -1,6 +1,6 @@
 // libtest.cc 
 //	Driver code to call self-test routines for standard library
-//	classes -- bitmaps, lists, sorted lists, and hash tables.
+//	classes -- bitmaps, lists, sorted lists, heaps, and hash tables.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -10,13 +10,14 @@
 #include "libtest.h"
 #include "bitmap.h"
 #include "list.h"
+#include "heap.h"
 #include "hash.h"
 #include "sysdep.h"
 
 //----------------------------------------------------------------------
 // IntCompare
 //	Compare two integers together.  Serves as the comparison
-//	function for testing SortedLists
+//	function for testing SortedLists and Heaps
 //----------------------------------------------------------------------
 
 static int 
@@ -53,6 +54,10 @@ HashKey(char *str) {
 // Array of values to be inserted into a List or SortedList. 
 static int listTestVector[] = { 9, 5, 7 };
 
+// Array of values to be put on a Heap.  There are enough here
+// (with duplicates) to force the heap to grow.
+static int heapTestVector[] = { 9, 5, 7, 3, 8, 1, 5, 6, 2, 9, 4, 0 };
+
 // Array of values to be inserted into the HashTable
 // There are enough here to force a ReHash().
 static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
@@ -60,7 +65,7 @@ static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
 
 //----------------------------------------------------------------------
 // LibSelfTest
-//	Run self tests on bitmaps, lists, sorted lists, and 
+//	Run self tests on bitmaps, lists, sorted lists, heaps, and 
 //	hash tables.
 //----------------------------------------------------------------------
 
@@ -69,6 +74,7 @@ LibSelfTest () {
     BitMap *map = new BitMap(200);
     List<int> *list = new List<int>;
     SortedList<int> *sortList = new SortedList<int>(IntCompare);
+    Heap<int> *heap = new Heap<int>(IntCompare, 4);
     HashTable<int, char *> *hashTable = 
 	new HashTable<int, char *>(HashKey, HashInt);
 	
@@ -76,10 +82,12 @@ LibSelfTest () {
     map->SelfTest();
     list->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
     sortList->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
+    heap->SelfTest(heapTestVector, sizeof(heapTestVector)/sizeof(int));
     hashTable->SelfTest(hashTestVector, sizeof(hashTestVector)/sizeof(char *));
 
     delete map;
     delete list;
     delete sortList;
+    delete heap;
     delete hashTable;
 }
@@ -18,6 +18,9 @@
 
 #include "copyright.h"
 
+template <class T>
+SlabCache ListElement<T>::cache("ListElement", sizeof(ListElement<T>));
+
 //----------------------------------------------------------------------
 // ListElement<T>::ListElement
 // 	Initialize a list element, so it can be added somewhere on a list.
@@ -0,0 +1,194 @@
+// slab.cc
+//	Routines to manage a slab allocator: a cache of free objects of
+//	one size.  See slab.h for details.
+//
+//	Each slab starts with SlabAlign bytes holding the link to the
+//	next slab, followed by the objects.  A free object holds the link
+//	to the next free object in its first word.
+//
+//     	NOTE: Nachos only takes interrupts when they are re-enabled, or
+//	between user instructions -- never in the middle of Alloc or
+//	Free -- so no further mutual exclusion is needed.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "utility.h"
+#include "slab.h"
+
+SlabCache *SlabCache::allCaches = NULL;
+
+//----------------------------------------------------------------------
+// SlabCache::SlabCache
+//	Initialize a cache, with no slabs to start with.  A cache only
+//	goes on allCaches once it allocates its first slab, so it does
+//	not matter in what order static caches are constructed.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//	"size" is the size of each object, in bytes.
+//	"perSlab" is how many objects each slab holds.
+//----------------------------------------------------------------------
+
+SlabCache::SlabCache(char *debugName, int size, int perSlab)
+{
+    ASSERT(size > 0 && perSlab > 0);
+    name = debugName;
+    objectSize = divRoundUp(size, SlabAlign) * SlabAlign;
+    objectsPerSlab = perSlab;
+    slabs = freeList = NULL;
+    numAllocs = numFrees = numInUse = peakInUse = numSlabs = 0;
+    nextCache = NULL;
+}
+
+//----------------------------------------------------------------------
+// SlabCache::~SlabCache
+//	De-allocate the slabs, if none of their objects is still in use.
+//	Caches belonging to a class are static, so they go away as Nachos
+//	exits; by then, some objects may never have been deleted, and
+//	their slabs are left for the host to clean up.
+//----------------------------------------------------------------------
+
+SlabCache::~SlabCache()
+{
+    SlabCache **p;
+
+    for (p = &allCaches; *p != NULL; p = &(*p)->nextCache) {
+	if (*p == this) {
+	    *p = nextCache;
+	    break;
+	}
+    }
+    if (numInUse > 0) {
+	return;
+    }
+    while (slabs != NULL) {
+	char *slab = slabs;
+
+	slabs = *(char **) slab;
+	delete [] slab;
+    }
+}
+
+//----------------------------------------------------------------------
+// SlabCache::Grow
+//	Allocate a new slab, and put each of its objects on the free
+//	list, in address order.
+//----------------------------------------------------------------------
+
+void
+SlabCache::Grow()
+{
+    char *slab = new char[SlabAlign + objectsPerSlab * objectSize];
+
+    if (numSlabs == 0) {
+	nextCache = allCaches;
+	allCaches = this;
+    }
+    *(char **) slab = slabs;
+    slabs = slab;
+    numSlabs++;
+    for (int i = objectsPerSlab - 1; i >= 0; i--) {
+	char *object = slab + SlabAlign + i * objectSize;
+
+	*(char **) object = freeList;
+	freeList = object;
+    }
+}
+
+//----------------------------------------------------------------------
+// SlabCache::Alloc
+//	Take an object off the free list, growing the cache if it is
+//	empty.
+//
+// Returns:
+//	Uninitialized storage for the object.
+//
+//	"size" is how much storage the caller needs; it can be less
+//	than the cache's object size (for instance, a page table for
+//	fewer than the most pages), but not more.
+//----------------------------------------------------------------------
+
+void *
+SlabCache::Alloc(size_t size)
+{
+    char *object;
+
+    ASSERT((int) size <= objectSize);
+    if (freeList == NULL) {
+	Grow();
+    }
+    object = freeList;
+    freeList = *(char **) object;
+    numAllocs++;
+    if (++numInUse > peakInUse) {
+	peakInUse = numInUse;
+    }
+    return (void *) object;
+}
+
+//----------------------------------------------------------------------
+// SlabCache::Free
+//	Put an object back on the free list, where the next Alloc will
+//	find it.  Like delete, a NULL pointer is ignored.
+//
+//	"object" is storage returned by this cache's Alloc.
+//----------------------------------------------------------------------
+
+void
+SlabCache::Free(void *object)
+{
+    if (object == NULL) {
+	return;
+    }
+    ASSERT(numInUse > 0);
+    *(char **) object = freeList;
+    freeList = (char *) object;
+    numFrees++;
+    numInUse--;
+}
+
+//----------------------------------------------------------------------
+// SlabCache::Print
+//	Print how much the cache was used: objects allocated in all (and
+//	per simulated second), how many are still in use, and how many
+//	slabs that took -- the calls to new that were left.
+//
+//	"ticks" is how long Nachos has run.
+//----------------------------------------------------------------------
+
+void
+SlabCache::Print(int ticks)
+{
+    double seconds = ticks / 1000000.0;	// a tick is a microsecond
+
+    cout << "Slab " << name << ": size " << objectSize << ", allocs "
+	 << numAllocs;
+    if (seconds > 0) {
+	cout << " (" << numAllocs / seconds << "/s)";
+    }
+    cout << ", in use " << numInUse << ", peak " << peakInUse
+	 << ", slabs " << numSlabs;
+    if (seconds > 0) {
+	cout << " (" << numSlabs / seconds << "/s)";
+    }
+    cout << "\n";
+}
+
+//----------------------------------------------------------------------
+// SlabCache::PrintAll
+//	Print the statistics of every cache that has been used.
+//
+//	"ticks" is how long Nachos has run.
+//----------------------------------------------------------------------
+
+void
+SlabCache::PrintAll(int ticks)
+{
+    for (SlabCache *cache = allCaches; cache != NULL;
+	    cache = cache->nextCache) {
+	cache->Print(ticks);
+    }
+}
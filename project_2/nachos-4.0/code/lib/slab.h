@@ -0,0 +1,83 @@
+// slab.h
+//	Data structures for a slab allocator: a cache of free objects of
+//	one size, carved out of larger blocks ("slabs") of memory.
+//
+//	Kernel objects such as threads, list elements and pending
+//	interrupts are created and destroyed over and over while Nachos
+//	runs.  Rather than a call to new and delete for each one, a class
+//	can get its storage from a SlabCache of its own, by defining
+//
+//		void *operator new(size_t size) { return cache.Alloc(size); }
+//		void operator delete(void *p) { cache.Free(p); }
+//		static SlabCache cache;
+//
+//	so that the existing constructors and new/delete calls are used
+//	as they are.  A freed object goes on the cache's free list, and
+//	the next Alloc hands it back out; only when the free list is
+//	empty is a new slab allocated.  Slabs are never given back until
+//	the cache itself goes away.
+//
+//	Each cache counts its allocations, so that "-slab-stats" can
+//	report, at Halt, how many objects of each type were allocated
+//	per simulated second (taking a tick to be a microsecond), and
+//	how many calls to new that took.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "copyright.h"
+#include <stddef.h>
+
+// How many objects each slab holds, unless the cache says otherwise.
+const int SlabObjects = 32;
+
+// Every object, and the start of every slab, is aligned to this.
+const int SlabAlign = 16;
+
+// The following class defines a cache of equal-sized objects.
+
+class SlabCache {
+  public:
+    SlabCache(char *debugName, int size, int perSlab = SlabObjects);
+				// initialize a cache of objects of
+				// "size" bytes, empty to start with
+    ~SlabCache();		// de-allocate the cache
+
+    void *Alloc(size_t size);	// storage for one object of at most
+				// the cache's size
+    void Free(void *object);	// give back storage from Alloc
+
+    int NumInUse() { return numInUse; }
+    void Print(int ticks);	// print our statistics, "ticks" being
+				// how long Nachos has run
+    static void PrintAll(int ticks);
+				// print the statistics of every cache
+				// that has been used
+
+  private:
+    char *name;			// debugging assist
+    int objectSize;		// bytes per object, rounded up to
+				// SlabAlign
+    int objectsPerSlab;		// objects carved out of each slab
+    char *slabs;		// the slabs, chained through their
+				// first word
+    char *freeList;		// free objects, chained through their
+				// first word
+
+    int numAllocs;		// calls to Alloc
+    int numFrees;		// calls to Free
+    int numInUse;		// objects allocated and not yet freed
+    int peakInUse;		// most objects in use at once
+    int numSlabs;		// slabs allocated, i.e. calls to new
+
+    SlabCache *nextCache;	// next cache on allCaches
+    static SlabCache *allCaches;// every cache that has allocated a slab
+
+    void Grow();		// add a slab to the free list
+};
+
+#endif // SLAB_H
@@ -32,6 +32,7 @@
 #include "sys/file.h"
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/mman.h>
 
 #ifdef LINUX	 // at this point, linux doesn't support mprotect 
 #define NO_MPROT     
@@ -111,6 +112,22 @@ Delay(int seconds)
     (void) sleep((unsigned) seconds);
 }
 
+//----------------------------------------------------------------------
+// HostTime
+// 	Return the time on the host's clock, in nanoseconds since some
+//	point in the past.  Only differences between two calls mean
+//	anything; the resolution is that of gettimeofday.
+//----------------------------------------------------------------------
+
+double
+HostTime()
+{
+    struct timeval tv;
+
+    (void) gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1e9 + tv.tv_usec * 1e3;
+}
+
 //----------------------------------------------------------------------
 // Abort
 // 	Quit and drop core.
@@ -335,6 +352,60 @@ Tell(int fd)
 #endif
 }
 
+//----------------------------------------------------------------------
+// MapFile
+// 	Map the first "nBytes" of an open file into our address space,
+//	shared, so that stores to the map change the file.
+//	Return the address of the map, or NULL if the file can't be
+//	mapped.
+//
+//	"fd" -- the file, open for reading and writing
+//	"nBytes" -- how much of it to map
+//----------------------------------------------------------------------
+
+char *
+MapFile(int fd, int nBytes)
+{
+    void *addr = mmap(NULL, nBytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+		      fd, 0);
+
+    if (addr == MAP_FAILED) {
+	return NULL;
+    }
+    return (char *) addr;
+}
+
+//----------------------------------------------------------------------
+// UnmapFile
+// 	Undo MapFile.  Abort on error.
+//----------------------------------------------------------------------
+
+void
+UnmapFile(char *addr, int nBytes)
+{
+    int retVal = munmap(addr, nBytes);
+    ASSERT(retVal == 0);
+}
+
+//----------------------------------------------------------------------
+// SyncMappedFile
+// 	Write the changes made to part of a mapped file back to the
+//	file, and wait until the host says they are on its disk.
+//	msync wants a page-aligned address, so start at the beginning of
+//	the page.  Abort on error.
+//
+//	"addr" -- where the file is mapped
+//	"offset", "nBytes" -- the part of it to write back
+//----------------------------------------------------------------------
+
+void
+SyncMappedFile(char *addr, int offset, int nBytes)
+{
+    int start = offset - (offset % getpagesize());
+    int retVal = msync(addr + start, offset + nBytes - start, MS_SYNC);
+    ASSERT(retVal == 0);
+}
+
 
 //----------------------------------------------------------------------
 // Close
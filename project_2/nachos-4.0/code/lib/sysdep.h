@@ -23,6 +23,9 @@ extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
 
+// Time on the host's clock, in nanoseconds, for timing Nachos itself
+extern double HostTime();
+
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(void (*cleanup)(int));
 
@@ -51,12 +54,20 @@ extern int Tell(int fd);
 extern void Close(int fd);
 extern bool Unlink(char *name);
 
+// Map a file into memory, so it can be read and written with bcopy;
+// and make sure changes made through the map are on the host's disk.
+// For simulating the disk.
+extern char *MapFile(int fd, int nBytes);
+extern void UnmapFile(char *addr, int nBytes);
+extern void SyncMappedFile(char *addr, int offset, int nBytes);
+
 // Other C library routines that are used by Nachos.
 // These are assumed to be portable, so we don't include a wrapper.
 extern "C" {
 int atoi(const char *str);
 double atof(const char *str);
 int abs(int i);
+int ffs(int i);
 }
 
 #ifdef NETWORK
@@ -33,11 +33,15 @@ const int DiskSize = (MagicSize + (NumSectors * SectorSize));
 //	if it doesn't exist), and check the magic number to make sure it's 
 // 	ok to treat it as Nachos disk storage.
 //
+//	Then map the file into memory, unless compiled with -DNOMMAPDISK.
+//
 //	"name" -- text name of the file simulating the Nachos disk
 //	"toCall" -- object to call when disk read/write request completes
+//	"sync" -- if TRUE, put each write on the host's disk before
+//	   the request completes
 //----------------------------------------------------------------------
 
-Disk::Disk(char* name, CallBackObj *toCall)
+Disk::Disk(char* name, CallBackObj *toCall, bool sync)
 {
     int magicNum;
     int tmp = 0;
@@ -61,19 +65,53 @@ Disk::Disk(char* name, CallBackObj *toCall)
 	WriteFile(fileno, (char *)&tmp, sizeof(int));  
     }
     active = FALSE;
+
+    syncWrites = sync;
+    dirtyStart = DiskSize;
+    dirtyEnd = 0;
+#ifndef NOMMAPDISK
+    image = MapFile(fileno, DiskSize);
+#else
+    image = NULL;
+#endif
+    DEBUG(dbgDisk, "Disk image is " << (image != NULL ? "mapped" : "not mapped")
+	  << (syncWrites ? ", synced on every write" : ""));
 }
 
 //----------------------------------------------------------------------
 // Disk::~Disk()
 // 	Clean up disk simulation, by closing the UNIX file representing the
-//	disk.
+//	disk.  What has been written is put on the host's disk first.
 //----------------------------------------------------------------------
 
 Disk::~Disk()
 {
+    if (image != NULL) {
+	Flush();
+	UnmapFile(image, DiskSize);
+    }
     Close(fileno);
 }
 
+//----------------------------------------------------------------------
+// Disk::Flush()
+// 	Put every sector written since the last Flush on the host's
+//	disk, and wait until it is there.  Only the span of the file
+//	that was written is synced.  Takes no simulated time.
+//----------------------------------------------------------------------
+
+void
+Disk::Flush()
+{
+    if (image != NULL && dirtyStart < dirtyEnd) {
+	DEBUG(dbgDisk, "Syncing disk image, bytes " << dirtyStart << " to "
+	      << dirtyEnd);
+	SyncMappedFile(image, dirtyStart, dirtyEnd - dirtyStart);
+    }
+    dirtyStart = DiskSize;
+    dirtyEnd = 0;
+}
+
 //----------------------------------------------------------------------
 // Disk::PrintSector()
 // 	Dump the data in a disk read/write request, for debugging.
@@ -118,8 +156,12 @@ Disk::ReadRequest(int sectorNumber, char* data)
     ASSERT((sectorNumber >= 0) && (sectorNumber < NumSectors));
     
     DEBUG(dbgDisk, "Reading from sector " << sectorNumber);
-    Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
-    Read(fileno, data, SectorSize);
+    if (image != NULL) {
+	bcopy(image + SectorSize * sectorNumber + MagicSize, data, SectorSize);
+    } else {
+	Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
+	Read(fileno, data, SectorSize);
+    }
     if (debug->IsEnabled('d'))
 	PrintSector(FALSE, sectorNumber, data);
     
@@ -138,8 +180,20 @@ Disk::WriteRequest(int sectorNumber, char* data)
     ASSERT((sectorNumber >= 0) && (sectorNumber < NumSectors));
     
     DEBUG(dbgDisk, "Writing to sector " << sectorNumber);
-    Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
-    WriteFile(fileno, data, SectorSize);
+    if (image != NULL) {
+	int offset = SectorSize * sectorNumber + MagicSize;
+
+	bcopy(data, image + offset, SectorSize);
+	if (syncWrites) {
+	    SyncMappedFile(image, offset, SectorSize);
+	} else {
+	    dirtyStart = min(dirtyStart, offset);
+	    dirtyEnd = max(dirtyEnd, offset + SectorSize);
+	}
+    } else {
+	Lseek(fileno, SectorSize * sectorNumber + MagicSize, 0);
+	WriteFile(fileno, data, SectorSize);
+    }
     if (debug->IsEnabled('d'))
 	PrintSector(TRUE, sectorNumber, data);
     
@@ -46,6 +46,17 @@
 // disks these days now come with a track buffer.
 //
 // The track buffer simulation can be disabled by compiling with -DNOTRACKBUF
+//
+// The UNIX file is mapped into memory, so a sector is read or written
+// with a bcopy rather than two system calls.  The host writes changes
+// back to the file when it likes; Flush makes sure everything written
+// so far is on the host's disk.  With "sync", each write is on
+// the host's disk before the request completes, so the image is never
+// behind what Nachos was told was written, even if the host crashes.
+// Reading and writing the file with system calls instead can be chosen
+// by compiling with -DNOMMAPDISK (or happens if the file can't be
+// mapped); then writes are in the file at once, and sync has no
+// effect.  Either way, the simulated time for a request is the same.
 
 const int SectorSize = 128;		// number of bytes per disk sector
 const int SectorsPerTrack  = 32;	// number of sectors per disk track 
@@ -55,7 +66,8 @@ const int NumSectors = (SectorsPerTrack * NumTracks);
 
 class Disk : public CallBackObj {
   public:
-    Disk(char* name, CallBackObj *toCall); // Create a simulated disk.  
+    Disk(char* name, CallBackObj *toCall, bool sync = FALSE);
+					// Create a simulated disk.  
 					// Invoke toCall->CallBack() 
 					// when each request completes.
     ~Disk();				// Deallocate the disk.
@@ -70,20 +82,32 @@ class Disk : public CallBackObj {
     void CallBack();			// Invoked when disk request 
 					// finishes. In turn calls, callWhenDone.
 
+    void Flush();			// Put what has been written on the
+					// host's disk
+
     int ComputeLatency(int newSector, bool writing);	
     					// Return how long a request to 
 					// newSector will take: 
 					// (seek + rotational delay + transfer)
+    int TimeToSeek(int newSector, int *rotate); // time to get to the new track
+    int HeadSector() { return lastSector; }
+					// where the head is now: the sector
+					// of the previous request
 
   private:
     int fileno;				// UNIX file number for simulated disk 
+    char *image;			// Where the file is mapped, or NULL
+					// to use system calls
+    bool syncWrites;			// Put each write on the host's disk
+					// before it completes?
+    int dirtyStart, dirtyEnd;		// Bytes of the file written since
+					// the last Flush
     CallBackObj *callWhenDone;		// Invoke when any disk request finishes
     bool active;     			// Is a disk operation in progress?
     int lastSector;			// The previous disk request 
     int bufferInit;			// When the track buffer started 
 					// being loaded
 
-    int TimeToSeek(int newSector, int *rotate); // time to get to the new track
     int ModuloDiff(int to, int from);        // # sectors between to and from
     void UpdateLast(int newSector);
 };
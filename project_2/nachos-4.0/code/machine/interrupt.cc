@@ -29,29 +29,16 @@
 static char *intLevelNames[] = { "off", "on"};
 static char *intTypeNames[] = { "timer", "disk", "console write", 
 			"console read", "elevator", "network send", 
-			"network recv"};
+			"network recv", "cache flush"};
 
-//----------------------------------------------------------------------
-// PendingInterrupt::PendingInterrupt
-// 	Initialize a hardware device interrupt that is to be scheduled 
-//	to occur in the near future.
-//
-//	"callOnInt" is the object to call when the interrupt occurs
-//	"time" is when (in simulated time) the interrupt is to occur
-//	"kind" is the hardware device that generated the interrupt
-//----------------------------------------------------------------------
-
-PendingInterrupt::PendingInterrupt(CallBackObj *callOnInt, 
-					int time, IntType kind)
-{
-    callOnInterrupt = callOnInt;
-    when = time;
-    type = kind;
-}
+SlabCache PendingInterrupt::cache("PendingInterrupt",
+				  sizeof(PendingInterrupt));
 
 //----------------------------------------------------------------------
 // PendingCompare
-//	Compare to interrupts based on which should occur first.
+//	Compare to interrupts based on which should occur first.  Of
+//	two due at the same time, the one scheduled first goes first
+//	(the heap, unlike a sorted list, would not keep them in order).
 //----------------------------------------------------------------------
 
 static int
@@ -59,6 +46,8 @@ PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
 {
     if (x->when < y->when) { return -1; }
     else if (x->when > y->when) { return 1; }
+    else if (x->serial < y->serial) { return -1; }
+    else if (x->serial > y->serial) { return 1; }
     else { return 0; }
 }
 
@@ -72,9 +61,11 @@ PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new SortedList<PendingInterrupt *>(PendingCompare);
+    pending = new Heap<PendingInterrupt *>(PendingCompare);
+    numScheduled = 0;
     inHandler = FALSE;
     yieldOnReturn = FALSE;
+    preempted = NULL;
     status = SystemMode;
 }
 
@@ -154,9 +145,11 @@ Interrupt::OneTick()
     if (status == SystemMode) {
         stats->totalTicks += SystemTick;
 	stats->systemTicks += SystemTick;
+	kernel->currentThread->accounting->systemTicks += SystemTick;
     } else {					// USER_PROGRAM
 	stats->totalTicks += UserTick;
 	stats->userTicks += UserTick;
+	kernel->currentThread->accounting->userTicks += UserTick;
     }
     DEBUG(dbgInt, "== Tick " << stats->totalTicks << " ==");
 
@@ -170,7 +163,9 @@ Interrupt::OneTick()
     				// for a context switch, ok to do it now
 	yieldOnReturn = FALSE;
  	status = SystemMode;		// yield is a kernel routine
+	preempted = kernel->currentThread;
 	kernel->currentThread->Yield();
+	preempted = NULL;
 	status = oldStatus;
     }
 }
@@ -193,6 +188,38 @@ Interrupt::YieldOnReturn()
     yieldOnReturn = TRUE; 
 }
 
+//----------------------------------------------------------------------
+// Interrupt::Preempt
+// 	Called by the scheduler, with interrupts disabled, when a thread
+//	that should run ahead of the current one becomes ready.
+//
+//	From inside an interrupt handler, this is just YieldOnReturn.
+//	Otherwise the caller is kernel code (Fork, Semaphore::V, ...) that
+//	is in the middle of updating shared state, so we can't switch
+//	here either; instead the current thread yields the next time it
+//	re-enables interrupts, from OneTick.
+//----------------------------------------------------------------------
+
+void
+Interrupt::Preempt()
+{
+    ASSERT(level == IntOff);
+    yieldOnReturn = TRUE;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::isPreempting
+// 	Return TRUE if the current thread is giving up the CPU because
+//	OneTick is forcing it to (a time slice, or Preempt), rather than
+//	because it called Yield or Sleep itself.
+//----------------------------------------------------------------------
+
+bool
+Interrupt::isPreempting()
+{
+    return preempted != NULL && preempted == kernel->currentThread;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::Idle
 // 	Routine called when there is nothing in the ready queue.
@@ -235,6 +262,10 @@ Interrupt::Halt()
 {
     cout << "Machine halting!\n\n";
     kernel->stats->Print();
+    kernel->stats->PrintThreads();
+    if (kernel->slabStats) {
+	SlabCache::PrintAll(kernel->stats->totalTicks);
+    }
     delete kernel;	// Never returns.
 }
 
@@ -243,7 +274,9 @@ Interrupt::Halt()
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: put it on a heap ordered by when it is due,
+//	so that scheduling is O(log n) in the number of interrupts
+//	in flight, rather than O(n) with a sorted list.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -257,14 +290,58 @@ void
 Interrupt::Schedule(CallBackObj *toCall, int fromNow, IntType type)
 {
     int when = kernel->stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(toCall, when, type);
+    PendingInterrupt *toOccur = new PendingInterrupt;
 
     DEBUG(dbgInt, "Scheduling interrupt handler the " << intTypeNames[type] << " at time = " << when);
     ASSERT(fromNow > 0);
 
+    toOccur->callOnInterrupt = toCall;
+    toOccur->when = when;
+    toOccur->serial = numScheduled++;
+    toOccur->type = type;
     pending->Insert(toOccur);
 }
 
+//----------------------------------------------------------------------
+// Interrupt::Cancel
+// 	Take back the interrupts of "type" scheduled for "toCall" that
+//	have not fired yet, for instance when a device is reprogrammed
+//	or shut down before its operation completes.
+//
+//	The heap is looked through once, from the bottom up.  Whatever
+//	takes a removed interrupt's place has either been looked at
+//	already or is looked at next, so cancelling k of n interrupts
+//	takes O(n + k log n) steps.
+//
+//	NOTE: like Schedule, this is only called by the hardware device
+//	simulators, with interrupts disabled (or from a handler).
+//
+// Returns:
+//	The number of interrupts taken back.
+//
+//	"toCall" is the object the interrupts were scheduled for
+//	"type" is the hardware device that scheduled them
+//----------------------------------------------------------------------
+
+int
+Interrupt::Cancel(CallBackObj *toCall, IntType type)
+{
+    PendingInterrupt *p;
+    int cancelled = 0;
+
+    for (int i = pending->NumInHeap() - 1; i >= 0; i--) {
+	while (i < pending->NumInHeap()
+		&& (p = pending->Item(i))->callOnInterrupt == toCall
+		&& p->type == type) {
+	    DEBUG(dbgInt, "Cancelling interrupt handler the " << intTypeNames[type] << " at time = " << p->when);
+	    pending->RemoveAt(i);	// something else moves into slot i
+	    delete p;
+	    cancelled++;
+	}
+    }
+    return cancelled;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::CheckIfDue
 // 	Check if any interrupts are scheduled to occur, and if so, 
@@ -311,7 +388,7 @@ Interrupt::CheckIfDue(bool advanceClock)
 #endif
     inHandler = TRUE;
     do {
-        next = pending->RemoveFront();    // pull interrupt off list
+        next = pending->RemoveFront();    // pull interrupt off heap
         next->callOnInterrupt->CallBack();// call the interrupt handler
 	delete next;
     } while (!pending->IsEmpty() 
@@ -336,7 +413,8 @@ PrintPending (PendingInterrupt *pending)
 //----------------------------------------------------------------------
 // DumpState
 // 	Print the complete interrupt state - the status, and all interrupts
-//	that are scheduled to occur in the future.
+//	that are scheduled to occur in the future (not in order: they
+//	are printed as they are laid out in the heap).
 //----------------------------------------------------------------------
 
 void
@@ -37,8 +37,12 @@
 
 #include "copyright.h"
 #include "list.h"
+#include "heap.h"
+#include "slab.h"
 #include "callback.h"
 
+class Thread;
+
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
 enum IntStatus { IntOff, IntOn };
 
@@ -51,23 +55,30 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 // In Nachos, we support a hardware timer device, a disk, a console
 // display and keyboard, and a network.
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt, 
-			ElevatorInt, NetworkSendInt, NetworkRecvInt};
+			ElevatorInt, NetworkSendInt, NetworkRecvInt,
+			CacheFlushInt};
 
 // The following class defines an interrupt that is scheduled
 // to occur in the future.  The internal data structures are
 // left public to make it simpler to manipulate.
+//
+// Devices keep scheduling interrupts for as long as Nachos runs, so
+// the records come from a SlabCache rather than one call to new each.
 
 class PendingInterrupt {
   public:
-    PendingInterrupt(CallBackObj *callOnInt, int time, IntType kind);
-				// initialize an interrupt that will
-				// occur in the future
-
     CallBackObj *callOnInterrupt;// The object (in the hardware device
 				// emulator) to call when the interrupt occurs
     
     int when;			// When the interrupt is supposed to fire
+    int serial;			// Order of scheduling, so interrupts due
+				// at the same time fire first come,
+				// first served
     IntType type;		// for debugging
+
+    void *operator new(size_t size) { return cache.Alloc(size); }
+    void operator delete(void *p) { cache.Free(p); }
+    static SlabCache cache;	// where the records come from
 };
 
 // The following class defines the data structures for the simulation
@@ -98,6 +109,10 @@ class Interrupt {
     
     void YieldOnReturn();	// cause a context switch on return 
 				// from an interrupt handler
+    void Preempt();		// cause a context switch as soon as
+				// interrupts are re-enabled
+    bool isPreempting();	// is the running thread being
+				// forced off the CPU?
 
     MachineStatus getStatus() { return status; } 
     void setStatus(MachineStatus st) { status = st; }
@@ -118,17 +133,24 @@ class Interrupt {
     				// Schedule an interrupt to occur
 				// at time "when".  This is called
     				// by the hardware device simulators.
+    int Cancel(CallBackObj *callTo, IntType type);
+				// Take back any interrupts of "type"
+				// scheduled for "callTo"; returns
+				// how many there were
     
     void OneTick();       	// Advance simulated time
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    SortedList<PendingInterrupt *> *pending;		
-    				// the list of interrupts scheduled
-				// to occur in the future
+    Heap<PendingInterrupt *> *pending;		
+    				// the interrupts scheduled to occur
+				// in the future, soonest first
+    int numScheduled;		// for PendingInterrupt::serial
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
+    Thread *preempted;		// thread OneTick is forcing to yield,
+				// on behalf of yieldOnReturn
     MachineStatus status;	// idle, kernel mode, user mode
 
     // these functions are internal to the interrupt simulation code
@@ -71,6 +71,9 @@ Machine::Machine(bool debug)
     pageTable = NULL;
 #endif
 
+    userContext = NULL;
+    linked = FALSE;
+    linkedAddr = 0;
     singleStep = debug;
     CheckEndian();
 }
@@ -103,7 +106,12 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
     DEBUG(dbgMach, "Exception: " << exceptionNames[which]);
     
     registers[BadVAddrReg] = badVAddr;
+    if (which == PageFaultException) {
+	kernel->stats->numPageFaults++;
+	kernel->currentThread->accounting->pageFaults++;
+    }
     DelayedLoad(0, 0);			// finish anything in progress
+    BreakLink();			// as a real trap would
     kernel->interrupt->setStatus(SystemMode);
 //	cout << "entering system mode...\n";
     ExceptionHandler(which);		// interrupts are enabled at this point
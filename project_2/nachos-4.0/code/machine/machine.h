@@ -85,6 +85,7 @@ enum ExceptionType { NoException,           // Everything ok!
 
 class Instruction;
 class Interrupt;
+class Thread;
 
 class Machine {
   public:
@@ -132,7 +133,18 @@ class Machine {
 
     TranslationEntry *pageTable;
     unsigned int pageTableSize;
+
+    Thread *userContext;	// the thread whose user registers and
+				// page table are loaded, NULL if none;
+				// they are only saved when some other
+				// thread needs the machine
     bool ReadMem(int addr, int size, int* value);
+    bool WriteMem(int addr, int size, int value);
+
+    void BreakLink() { linked = FALSE; }
+				// make the next SC fail: the user
+				// program was interrupted by a trap, or
+				// some other thread has had the machine
   private:
 
 // Routines internal to the machine simulation -- DO NOT call these directly
@@ -143,7 +155,7 @@ class Machine {
     				// Run one instruction of a user program.
     
 //    bool ReadMem(int addr, int size, int* value);
-    bool WriteMem(int addr, int size, int value);
+//    bool WriteMem(int addr, int size, int value);
     				// Read or write 1, 2, or 4 bytes of virtual 
 				// memory (at addr).  Return FALSE if a 
 				// correct translation couldn't be found.
@@ -167,6 +179,10 @@ class Machine {
 
     int registers[NumTotalRegs]; // CPU registers, for executing user programs
 
+    bool linked;		// has an LL been done, with no trap or
+				// context switch since?
+    int linkedAddr;		// the address the LL loaded from
+
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
     int runUntilTime;		// drop back into the debugger when simulated
@@ -299,6 +299,21 @@ Machine::OneInstruction(Instruction *instr)
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
 	break;
+
+      case OP_LL:			// LW, and remember the address, so
+					// that SC can tell if it is untouched
+	tmp = registers[instr->rs] + instr->extra;
+	if (tmp & 0x3) {
+	    RaiseException(AddressErrorException, tmp);
+	    return;
+	}
+	if (!ReadMem(tmp, 4, &value))
+	    return;
+	linkedAddr = tmp;
+	linked = TRUE;
+	nextLoadReg = instr->rt;
+	nextLoadValue = value;
+	break;
     	
       case OP_LWL:	  
 	tmp = registers[instr->rs] + instr->extra;
@@ -496,6 +511,20 @@ Machine::OneInstruction(Instruction *instr)
 		(registers[instr->rs] + instr->extra), 4, registers[instr->rt]))
 	    return;
 	break;
+
+      case OP_SC:			// SW, only if nothing could have
+					// changed the word since our LL;
+					// rt says whether it did
+	tmp = registers[instr->rs] + instr->extra;
+	if (linked && linkedAddr == tmp) {
+	    if (!WriteMem(tmp, 4, registers[instr->rt]))
+		return;
+	    registers[instr->rt] = 1;
+	} else {
+	    registers[instr->rt] = 0;
+	}
+	linked = FALSE;
+	break;
 	
       case OP_SWL:	  
 	tmp = registers[instr->rs] + instr->extra;
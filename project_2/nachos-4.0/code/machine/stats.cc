@@ -10,6 +10,7 @@
 #include "copyright.h"
 #include "debug.h"
 #include "stats.h"
+#include "sysdep.h"
 
 //----------------------------------------------------------------------
 // Statistics::Statistics
@@ -20,8 +21,88 @@ Statistics::Statistics()
 {
     totalTicks = idleTicks = systemTicks = userTicks = 0;
     numDiskReads = numDiskWrites = 0;
+    numCacheHits = numCacheMisses = numCacheWriteBacks = 0;
+    numDiskQueued = diskSeekTracks = diskQueueDepth = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numContextSwitches = numPreemptions = numDeadlineMisses = 0;
+    numUserSaves = numUserRestores = numUserReloadsSaved = 0;
+    threadStats = new ThreadStatisticsTable;
+    finishedStats = new FinishedThreadStatistics;
+    olderStats = new ThreadStatistics("older");
+    numOlder = 0;
+}
+
+//----------------------------------------------------------------------
+// Statistics::AddThread
+// 	Start a record of the CPU accounting for a new thread, and
+//	return it; the thread updates it as it runs.
+//
+//	"threadName" is the name of the thread, for the table.
+//----------------------------------------------------------------------
+
+ThreadStatistics *
+Statistics::AddThread(char *threadName)
+{
+    ThreadStatistics *record = new ThreadStatistics(threadName);
+
+    threadStats->Append(record);
+    return record;
+}
+
+//----------------------------------------------------------------------
+// Statistics::RetireThread
+// 	Note that a thread has been deleted.  Its record stays in the
+//	table, but once more than KeepFinishedThreads records of deleted
+//	threads are kept, the oldest is added into olderStats and thrown
+//	away, so that a long run does not keep a record for every thread
+//	it ever created.
+//
+//	"record" is what AddThread returned for the thread.
+//----------------------------------------------------------------------
+
+void
+Statistics::RetireThread(ThreadStatistics *record)
+{
+    ThreadStatistics *oldest;
+
+    ASSERT(!record->finished);
+    if (record->dropped) {
+	delete record;
+	return;
+    }
+    record->finished = TRUE;
+    finishedStats->Append(record);
+    if (finishedStats->NumInList() > KeepFinishedThreads) {
+	oldest = finishedStats->RemoveFront();
+	threadStats->Remove(oldest);
+	olderStats->Add(oldest);
+	numOlder++;
+	delete oldest;
+    }
+}
+
+//----------------------------------------------------------------------
+// Statistics::DropThread
+// 	Take a thread's record out of the table, for threads (such as
+//	those forked by a benchmark) that would only clutter it up.  If
+//	the thread is still around, the record is thrown away once it
+//	is deleted.  O(1).
+//
+//	"record" is what AddThread returned for the thread.
+//----------------------------------------------------------------------
+
+void
+Statistics::DropThread(ThreadStatistics *record)
+{
+    ASSERT(!record->dropped);
+    threadStats->Remove(record);
+    if (record->finished) {
+	finishedStats->Remove(record);
+	delete record;
+    } else {
+	record->dropped = TRUE;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -37,9 +118,93 @@ Statistics::Print()
 		cout << ", system " << systemTicks << ", user " << userTicks <<"\n";
     cout << "Disk I/O: reads " << numDiskReads;
 		cout << ", writes " << numDiskWrites << "\n";
+    if (numCacheHits + numCacheMisses > 0) {	// a file system ran
+	cout << "Buffer cache: hits " << numCacheHits;
+		cout << ", misses " << numCacheMisses;
+		cout << ", write-backs " << numCacheWriteBacks << "\n";
+    }
+    if (numDiskQueued > 0) {
+	cout << "Disk queue: requests " << numDiskQueued;
+		cout << ", average seek " << (double) diskSeekTracks / numDiskQueued;
+		cout << " tracks, average depth ";
+		cout << (double) diskQueueDepth / numDiskQueued << "\n";
+    }
 		cout << "Console I/O: reads " << numConsoleCharsRead;
     cout << ", writes " << numConsoleCharsWritten << "\n";
     cout << "Paging: faults " << numPageFaults << "\n";
     cout << "Network I/O: packets received " << numPacketsRecvd;
 		cout << ", sent " << numPacketsSent << "\n";
+    cout << "Scheduling: context switches " << numContextSwitches;
+		cout << ", preemptions " << numPreemptions;
+		cout << ", deadline misses " << numDeadlineMisses << "\n";
+    cout << "User context: saves " << numUserSaves;
+		cout << ", restores " << numUserRestores;
+		cout << ", reloads avoided " << numUserReloadsSaved << "\n";
+}
+
+//----------------------------------------------------------------------
+// Statistics::PrintThreads
+// 	Print the CPU accounting of every thread, one row per thread,
+//	in the order they were created.  Deleted threads whose records
+//	are no longer kept come first, added up into one row.
+//----------------------------------------------------------------------
+
+void
+Statistics::PrintThreads()
+{
+    ThreadStatistics *record;
+
+    cout << "Thread\tuser\tsystem\tready\tblocked\tvol\tinvol\tfaults\n";
+    if (numOlder > 0) {
+	cout << numOlder << " ";
+	olderStats->Print();
+    }
+    for (record = threadStats->Front(); record != NULL;
+	    record = threadStats->Next(record)) {
+	record->Print();
+    }
+}
+
+//----------------------------------------------------------------------
+// ThreadStatistics::ThreadStatistics
+// 	Initialize a thread's CPU accounting to zero.
+//----------------------------------------------------------------------
+
+ThreadStatistics::ThreadStatistics(char *threadName)
+{
+    strncpy(name, threadName, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    userTicks = systemTicks = readyTicks = blockedTicks = 0;
+    voluntarySwitches = involuntarySwitches = pageFaults = 0;
+    finished = dropped = FALSE;
+}
+
+//----------------------------------------------------------------------
+// ThreadStatistics::Add
+// 	Add another thread's CPU accounting into ours.
+//----------------------------------------------------------------------
+
+void
+ThreadStatistics::Add(ThreadStatistics *other)
+{
+    userTicks += other->userTicks;
+    systemTicks += other->systemTicks;
+    readyTicks += other->readyTicks;
+    blockedTicks += other->blockedTicks;
+    voluntarySwitches += other->voluntarySwitches;
+    involuntarySwitches += other->involuntarySwitches;
+    pageFaults += other->pageFaults;
+}
+
+//----------------------------------------------------------------------
+// ThreadStatistics::Print
+// 	Print one thread's row of the table.
+//----------------------------------------------------------------------
+
+void
+ThreadStatistics::Print()
+{
+    cout << name << "\t" << userTicks << "\t" << systemTicks << "\t"
+	 << readyTicks << "\t" << blockedTicks << "\t" << voluntarySwitches
+	 << "\t" << involuntarySwitches << "\t" << pageFaults << "\n";
 }
@@ -12,6 +12,47 @@
 #define STATS_H
 
 #include "copyright.h"
+#include "dlist.h"
+
+// How many records of deleted threads are kept for the table printed
+// when Nachos halts; older ones are added into a single row.
+const int KeepFinishedThreads = 32;
+
+// The following class defines the CPU accounting kept for each thread.
+// A thread's record outlives the thread, so that the table printed
+// when Nachos halts covers the threads that ran (the most recent
+// KeepFinishedThreads of those that are gone, and a total for the rest).
+
+class ThreadStatistics {
+  public:
+    ThreadStatistics(char *threadName);
+
+    char name[16];		// copy of the thread's name
+    int userTicks;		// time spent executing user code
+    int systemTicks;		// time spent executing system code
+    int readyTicks;		// time spent on the ready list
+    int blockedTicks;		// time spent blocked (Sleep, I/O, locks)
+    int voluntarySwitches;	// times we gave up the CPU ourselves
+    int involuntarySwitches;	// times we were preempted
+    int pageFaults;		// page faults we took
+
+    bool finished;		// has the thread been deleted?
+    bool dropped;		// is the record to be thrown away once
+				// it has been?
+    DLink<ThreadStatistics> tableLink;	// place in the table
+    DLink<ThreadStatistics> finishedLink;
+				// place among the records of deleted
+				// threads, oldest first
+
+    void Add(ThreadStatistics *other);
+				// add other's accounting into ours
+    void Print();		// print one row of the table
+};
+
+typedef DList<ThreadStatistics, &ThreadStatistics::tableLink>
+		ThreadStatisticsTable;
+typedef DList<ThreadStatistics, &ThreadStatistics::finishedLink>
+		FinishedThreadStatistics;
 
 // The following class defines the statistics that are to be kept
 // about Nachos behavior -- how much time (ticks) elapsed, how
@@ -30,15 +71,55 @@ class Statistics {
 
     int numDiskReads;		// number of disk read requests
     int numDiskWrites;		// number of disk write requests
+    int numCacheHits;		// number of sectors found in the buffer
+				// cache
+    int numCacheMisses;		// number of sectors that were not
+				// found in the buffer cache
+    int numCacheWriteBacks;	// number of dirty sectors written back
+    int numDiskQueued;		// number of requests through the
+				// synchronous disk's queue
+    int diskSeekTracks;		// tracks the head crossed for them
+    int diskQueueDepth;		// queue depth each one found, counting
+				// itself, added up
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
+    int numContextSwitches;	// number of times the CPU was switched
+				// to a different thread
+    int numPreemptions;		// number of times a running thread was
+				// forced off the CPU
+    int numDeadlineMisses;	// number of real-time jobs that were not
+				// done by their deadline
+    int numUserSaves;		// number of times a thread's user
+				// registers were saved from the machine
+    int numUserRestores;	// number of times they were loaded back
+    int numUserReloadsSaved;	// number of times a user thread got the
+				// CPU back with its registers still loaded
+
+    ThreadStatisticsTable *threadStats;
+				// a record for every thread, in the
+				// order they were created
+    FinishedThreadStatistics *finishedStats;
+				// those of deleted threads, oldest first
+    ThreadStatistics *olderStats;
+				// total of the records of deleted threads
+				// that are no longer kept
+    int numOlder;		// how many threads that total covers
 
     Statistics(); 		// initialize everything to zero
 
+    ThreadStatistics *AddThread(char *threadName);
+				// start keeping a record for a new thread
+    void RetireThread(ThreadStatistics *record);
+				// the thread has been deleted; keep its
+				// record for a while
+    void DropThread(ThreadStatistics *record);
+				// forget a thread, leaving it out of the
+				// table
     void Print();		// print collected statistics
+    void PrintThreads();	// print the per-thread table
 };
 
 // Constants used to reflect the relative time an operation would
@@ -10,6 +10,11 @@
 //      In order to introduce some randomness into time-slicing, if "doRandom"
 //      is set, then the interrupt is comes after a random number of ticks.
 //
+//	Like a one-shot timer on a real machine, the timer can also be
+//	reprogrammed to go off at some other time (SetNext), so that a
+//	kernel with nothing to time-slice need not be interrupted every
+//	TimerTicks.
+//
 //	Remember -- nothing in here is part of Nachos.  It is just
 //	an emulation for the hardware that Nachos is running on top of.
 //
@@ -40,9 +45,37 @@ Timer::Timer(bool doRandom, CallBackObj *toCall)
     randomize = doRandom;
     callPeriodically = toCall;
     disable = FALSE;
+    armedAt = -1;
     SetInterrupt();
 }
 
+//----------------------------------------------------------------------
+// Timer::~Timer
+//      Take back the interrupt we are waiting for, so that it is not
+//	delivered to a timer that no longer exists.
+//----------------------------------------------------------------------
+
+Timer::~Timer()
+{
+    Disable();
+}
+
+//----------------------------------------------------------------------
+// Timer::Disable
+//      Turn the timer off: take back the interrupt we are waiting
+//	for, and schedule no more until SetNext is called.
+//----------------------------------------------------------------------
+
+void
+Timer::Disable()
+{
+    disable = TRUE;
+    if (armedAt >= 0) {
+	(void) kernel->interrupt->Cancel(this, TimerInt);
+	armedAt = -1;
+    }
+}
+
 //----------------------------------------------------------------------
 // Timer::CallBack
 //      Routine called when interrupt is generated by the hardware 
@@ -52,11 +85,16 @@ Timer::Timer(bool doRandom, CallBackObj *toCall)
 void 
 Timer::CallBack() 
 {
+    ASSERT(armedAt >= 0 && armedAt <= kernel->stats->totalTicks);
+    armedAt = -1;
+
     // invoke the Nachos interrupt handler for this device
     callPeriodically->CallBack();
     
-    SetInterrupt();	// do last, to let software interrupt handler
+    if (armedAt < 0) {	// unless the handler reprogrammed us
+	SetInterrupt();	// do last, to let software interrupt handler
     			// decide if it wants to disable future interrupts
+    }
 }
 
 //----------------------------------------------------------------------
@@ -76,6 +114,38 @@ Timer::SetInterrupt()
 	     delay = 1 + (RandomNumber() % (TimerTicks * 2));
         }
        // schedule the next timer device interrupt
-       kernel->interrupt->Schedule(this, delay, TimerInt);
+       Arm(delay);
+    }
+}
+
+//----------------------------------------------------------------------
+// Timer::SetNext
+//      Reprogram the timer to interrupt "delay" ticks from now, rather
+//	than when it was going to (if at all).  After that interrupt, the
+//	timer goes back to interrupting every TimerTicks, unless it is
+//	reprogrammed or disabled again.
+//----------------------------------------------------------------------
+
+void
+Timer::SetNext(int delay)
+{
+    ASSERT(delay > 0);
+    disable = FALSE;
+    Arm(delay);
+}
+
+//----------------------------------------------------------------------
+// Timer::Arm
+//      Schedule the next timer interrupt, taking back the one we were
+//	waiting for, if any.
+//----------------------------------------------------------------------
+
+void
+Timer::Arm(int delay)
+{
+    if (armedAt >= 0) {
+	(void) kernel->interrupt->Cancel(this, TimerInt);
     }
+    armedAt = kernel->stats->totalTicks + delay;
+    kernel->interrupt->Schedule(this, delay, TimerInt);
 }
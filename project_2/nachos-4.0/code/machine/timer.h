@@ -30,17 +30,24 @@ class Timer : public CallBackObj {
     Timer(bool doRandom, CallBackObj *toCall);
 				// Initialize the timer, and callback to "toCall"
 				// every time slice.
-    virtual ~Timer() {}
+    virtual ~Timer();		// take back our pending interrupt
     
-    void Disable() { disable = TRUE; }
-    				// Turn timer device off, so it doesn't
+    void Disable();		// Turn timer device off, so it doesn't
 				// generate any more interrupts.
+    void SetNext(int delay);	// Reprogram the timer (turning it back
+				// on) to interrupt "delay" ticks from
+				// now, instead of when it was going to
+    int NextInterrupt() { return armedAt; }
+				// When the timer will interrupt next;
+				// -1 if it is off
 
   private:
     bool randomize;		// set if we need to use a random timeout delay
     CallBackObj *callPeriodically; // call this every TimerTicks time units 
     bool disable;		// turn off the timer device after next
     				// interrupt.
+    int armedAt;		// when the interrupt we are waiting for
+				// is due; -1 if none
     
     void CallBack();		// called internally when the hardware
 				// timer generates an interrupt
@@ -48,6 +55,8 @@ class Timer : public CallBackObj {
     void SetInterrupt();  	// cause an interrupt to occur in the
     				// the future after a fixed or random
 				// delay
+    void Arm(int delay);	// schedule the interrupt, in place of
+				// the one we were waiting for
 };
 
 #endif // TIMER_H
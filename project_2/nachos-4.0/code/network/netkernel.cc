@@ -97,8 +97,8 @@ NetKernel::Run()
 //----------------------------------------------------------------------
 
 void
-NetKernel::SelfTest(bool var1, bool var2) {
-    UserProgKernel::SelfTest(var1, var2);		// this requires each nachos
+NetKernel::SelfTest(int testCase) {
+    UserProgKernel::SelfTest(testCase);	// this requires each nachos
 					// kernel to have its own window!
 
     if (hostName == 0 || hostName == 1) {
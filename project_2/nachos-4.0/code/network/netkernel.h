@@ -28,7 +28,8 @@ class NetKernel : public UserProgKernel {
 
     void Run();			// do kernel stuff 
 
-    void SelfTest(bool var1, bool var2);		// test whether kernel is working
+    void SelfTest(int testCase = 0);	// test whether kernel is working,
+					// then run TestCase<testCase>, if any
 
   // public for convenience
     PostOfficeInput *postOfficeIn;
@@ -19,6 +19,8 @@
 #include "copyright.h"
 #include "post.h"
 
+SlabCache Mail::cache("Mail", sizeof(Mail));
+
 //----------------------------------------------------------------------
 // Mail::Mail
 //      Initialize a single mail message, by concatenating the headers to
@@ -32,6 +32,7 @@
 #include "network.h"
 #include "synchlist.h"
 #include "synch.h"
+#include "slab.h"
 
 // Mailbox address -- uniquely identifies a mailbox on a given machine.
 // A mailbox is just a place for temporary storage for messages.
@@ -70,6 +71,11 @@ class Mail {
      PacketHeader pktHdr;	// Header appended by Network
      MailHeader mailHdr;	// Header appended by PostOffice
      char data[MaxMailSize];	// Payload -- message data
+
+     void *operator new(size_t size) { return cache.Alloc(size); }
+     void operator delete(void *p) { cache.Free(p); }
+     static SlabCache cache;	// a message is allocated for every
+				// packet received
 };
 
 // The following class defines a single mailbox, or temporary storage
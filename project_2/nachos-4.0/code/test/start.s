@@ -138,6 +138,14 @@ PrintInt:
 	j       $31
 	.end    PrintInt
 
+	.globl  SetTickets
+	.ent    SetTickets
+SetTickets:
+	addiu   $2,$0,SC_SetTickets
+	syscall
+	j       $31
+	.end    SetTickets
+
 
 	.globl  Sleep
 	.ent    Sleep
@@ -147,6 +155,113 @@ Sleep:
 	j       $31
 	.end    Sleep
 
+	.globl  SemCreate
+	.ent    SemCreate
+SemCreate:
+	addiu   $2,$0,SC_SemCreate
+	syscall
+	j       $31
+	.end    SemCreate
+
+	.globl  FutexWait
+	.ent    FutexWait
+FutexWait:
+	addiu   $2,$0,SC_FutexWait
+	syscall
+	j       $31
+	.end    FutexWait
+
+	.globl  FutexWake
+	.ent    FutexWake
+FutexWake:
+	addiu   $2,$0,SC_FutexWake
+	syscall
+	j       $31
+	.end    FutexWake
+
+/* -------------------------------------------------------------
+ * SemWait, SemSignal
+ *	Semaphores kept in user memory (see syscall.h).  The count is
+ *	changed with LL/SC: the SC fails if anything could have touched
+ *	the word since the LL, and we try again.  Nothing traps unless
+ *	a thread has to sleep (FutexWait) or wake one up (FutexWake).
+ *
+ *	A count of -1 means 0, with threads perhaps asleep on the word.
+ *	A thread that has slept cannot tell if others still are, so it
+ *	leaves -1 rather than 0 behind it -- and if it leaves a positive
+ *	count, wakes the next sleeper itself.
+ *
+ *	Written with delay slots filled by hand; the nop after each ll
+ *	is its load delay.
+ * -------------------------------------------------------------
+ */
+
+	.globl  SemWait
+	.ent    SemWait
+SemWait:
+	.set	noreorder
+	move	$9,$0		/* $9: have we slept yet? */
+1:	ll	$8,0($4)	/* $8: the count */
+	nop
+	blez	$8,3f		/* nothing to take: wait */
+	addiu	$10,$8,-1	/* $10: the count once we take one */
+	move	$11,$10		/* kept, as sc overwrites $10 */
+	bne	$10,$0,2f
+	nop
+	bne	$9,$0,2f	/* taking the last one after sleeping: */
+	addiu	$10,$0,-1	/* leave -1 */
+	move	$10,$0		/* otherwise 0 */
+2:	sc	$10,0($4)
+	beq	$10,$0,1b	/* the word may have changed: retry */
+	nop
+	beq	$9,$0,5f	/* never slept: done */
+	nop
+	blez	$11,5f		/* nothing left for another sleeper */
+	nop
+	addiu	$5,$0,1
+	addiu	$2,$0,SC_FutexWake
+	syscall
+5:	j	$31
+	nop
+3:	bltz	$8,4f		/* already marked as waited on */
+	addiu	$10,$0,-1
+	sc	$10,0($4)	/* mark 0 as -1: we are about to sleep */
+	beq	$10,$0,1b
+	nop
+4:	addiu	$9,$0,1
+	addiu	$5,$0,-1
+	addiu	$2,$0,SC_FutexWait
+	syscall			/* sleep, if the count is still -1 */
+	b	1b
+	nop
+	.set	reorder
+	.end    SemWait
+
+	.globl  SemSignal
+	.ent    SemSignal
+SemSignal:
+	.set	noreorder
+1:	ll	$8,0($4)	/* $8: the count */
+	nop
+	bltz	$8,2f		/* someone may be asleep */
+	addiu	$10,$8,1
+	sc	$10,0($4)
+	beq	$10,$0,1b	/* the word may have changed: retry */
+	nop
+	j	$31
+	nop
+2:	addiu	$10,$0,1	/* -1 stands for 0 */
+	sc	$10,0($4)
+	beq	$10,$0,1b
+	nop
+	addiu	$5,$0,1
+	addiu	$2,$0,SC_FutexWake
+	syscall			/* wake one sleeper */
+	j	$31
+	nop
+	.set	reorder
+	.end    SemSignal
+
 
 
 /* dummy function to keep gcc happy */
@@ -0,0 +1,19 @@
+#include "syscall.h"
+
+int	sem;
+int	word;
+
+main()
+	{
+		int	n;
+      SemCreate(&sem, 1);		/* a mutex */
+      for(n = 0; n < 5; n++){
+         SemWait(&sem);		/* uncontended: no trap */
+         PrintInt(n);
+         SemSignal(&sem);
+      }
+      PrintInt(sem);			/* 1 */
+      word = 0;
+      PrintInt(FutexWait(&word, 1));	/* 1: word is not 1, no sleep */
+      PrintInt(FutexWake(&word, 1));	/* 0: no one asleep */
+	}
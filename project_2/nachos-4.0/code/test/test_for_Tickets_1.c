@@ -0,0 +1,13 @@
+#include "syscall.h"
+
+main()
+	{
+		int	m, n;
+      SetTickets(300);
+      for(m = 10; m < 15; m++){
+         for(n = 0; n < 10000; n++)
+            ;
+         PrintInt(m);
+      }
+	}
+
@@ -0,0 +1,13 @@
+#include "syscall.h"
+
+main()
+	{
+		int	m, n;
+      SetTickets(100);
+      for(m = -1; m > -6; m--){
+         for(n = 0; n < 10000; n++)
+            ;
+         PrintInt(m);
+      }
+	}
+
@@ -27,61 +27,112 @@ using namespace std;
 
 Alarm::Alarm(bool doRandom)
 {
+    sleepers = new TimingWheel(kernel->stats->totalTicks / TimerTicks);
+    ticking = TRUE;
     timer = new Timer(doRandom, this);
 }
 
+//----------------------------------------------------------------------
+// Alarm::WaitUntil
+//      Suspend the current thread until the x'th timer period from now
+//	begins (the x'th timer interrupt, when the timer is ticking).
+//	A thread asking to sleep for less than one period sleeps until
+//	the next one begins.
+//
+//	"x" -- how many timer periods to sleep
+//----------------------------------------------------------------------
 
-//My self-defined function : void make_thread_to_sleep(int time_argument_, Thread * thr_)
-void sleeping_space_for_threads::make_thread_to_sleep(int time_argument_, Thread * thr_) {
-    IntStatus indicating_status;
-    indicating_status = (*((*kernel).interrupt)).getLevel();
-    ASSERT(indicating_status == IntOff);
-    int total_time = now_time + time_argument_;
-    sleeping_space s = sleeping_space(total_time, thr_);
-    vector_containing_sleeping_spaces.push_back(s);
-    (*thr_).Sleep(0);
-}
-
-
-//My self-defined function : int check_thread()
-int sleeping_space_for_threads::check_thread() {
-    now_time ++;
-    int sleep_enough = 0;
-    for (int j = 0; j < vector_containing_sleeping_spaces.size(); j++) {
-        if (vector_containing_sleeping_spaces[j].time_to_wake_up <= now_time) { //this means that this thread already slept enough!
-            sleep_enough = 1;
-            Thread * thread_that_is_going_to_wake_up = vector_containing_sleeping_spaces[j].thread_that_is_sleeping;
-            (*((*kernel).scheduler)).ReadyToRun(thread_that_is_going_to_wake_up);
-            vector_containing_sleeping_spaces.erase(vector_containing_sleeping_spaces.begin()+j);            
-        }
+void
+Alarm::WaitUntil(int x)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Thread *thread = kernel->currentThread;
+    int now = kernel->stats->totalTicks / TimerTicks;
+    int when = (x > 0) ? now + x : now + 1;
+    int next = timer->NextInterrupt();
+
+    DEBUG(dbgThread, "Thread " << thread->getName() << " sleeping until period " << when);
+    sleepers->Insert(thread, when);
+    if (!ticking && (next < 0 || next > when * TimerTicks)) {
+	// the timer would not go off in time; bring it forward
+	timer->SetNext(when * TimerTicks - kernel->stats->totalTicks);
     }
-    return sleep_enough;
+    thread->Sleep(FALSE);
+    (void) kernel->interrupt->SetLevel(oldLevel);
 }
 
+//----------------------------------------------------------------------
+// Alarm::NeedsTicks
+//      Return TRUE if the timer must keep interrupting every period:
+//	real-time jobs are released on timer interrupts, and Priority,
+//	Lottery, Stride, MLFQ and CFS time-slice the running thread.
+//	The others only need the timer to wake up sleeping threads.
+//
+//	"idle" -- TRUE if there is no thread running
+//----------------------------------------------------------------------
 
-//Implementation of function: void WaitUntil(int x)
-void Alarm::WaitUntil(int x) {
-    IntStatus original_status;
-    Thread * current_thread;
-    original_status = (*((*kernel).interrupt)).SetLevel(IntOff);
-    current_thread = (*kernel).currentThread;
+bool
+Alarm::NeedsTicks(bool idle)
+{
+    SchedulerType type = kernel->scheduler->get_scheduler_type();
 
+    if (kernel->scheduler->AnyRealTime()) {
+	return TRUE;
+    }
+    return !idle && (type == Priority || type == Lottery || type == Stride
+			|| type == MLFQ || type == CFS);
+}
 
-    (*current_thread).set_start_time((*((*kernel).stats)).userTicks);
+//----------------------------------------------------------------------
+// Alarm::StartTicking
+//      Called when the CPU is about to run a thread after being idle
+//	(or when the scheduler changes): if the timer stopped ticking
+//	while there was nothing to time-slice, start it again, lined up
+//	with the period boundaries.
+//----------------------------------------------------------------------
 
+void
+Alarm::StartTicking()
+{
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
 
-    int time_spent_executing_user_code = (*((*kernel).stats)).userTicks; //by userTicks' definition.
-    int thread_start_time = (*current_thread).start_time_of_the_thread;
-    int thread_predicted_burst_time = (*current_thread).predicted_burst_time_of_the_thread;
-    int time_sum = time_spent_executing_user_code - thread_start_time + thread_predicted_burst_time;
-    (*current_thread).set_predicted_burst_time(time_sum);
+    if (!ticking && NeedsTicks(FALSE)) {
+	ticking = TRUE;
+	timer->SetNext(TimerTicks - kernel->stats->totalTicks % TimerTicks);
+    }
+}
 
+//----------------------------------------------------------------------
+// Alarm::WaitNextPeriod
+//	Called by a real-time thread (see Scheduler::AdmitRealTime) when
+//	its current job is done.  Record a miss if the job finished after
+//	its deadline, then wait until the next job is released; if that
+//	is already due (we are running late), start on it right away.
+//----------------------------------------------------------------------
 
-    a_sleeping_space_for_threads.make_thread_to_sleep(x, current_thread);
+void
+Alarm::WaitNextPeriod()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Thread *thread = kernel->currentThread;
+    int now = kernel->stats->totalTicks;
 
+    ASSERT(thread->rtPeriod > 0);
 
-    (*((*kernel).interrupt)).SetLevel(original_status);
-} 
+    if (now > thread->rtAbsDeadline && !thread->rtMissed) {
+        kernel->stats->numDeadlineMisses++;
+    }
+    thread->rtRelease += thread->rtPeriod;
+    thread->rtMissed = FALSE;
+    if (now >= thread->rtRelease) {
+        thread->rtAbsDeadline = thread->rtRelease + thread->rtDeadline;
+    } else {
+        DEBUG(dbgThread, "Real-time thread " << thread->getName() << " waiting for release at " << thread->rtRelease);
+        thread->rtWaiting = TRUE;
+        thread->Sleep(FALSE);		// CheckRealTime wakes us up
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
 
 
 //----------------------------------------------------------------------
@@ -98,28 +149,58 @@ void Alarm::WaitUntil(int x) {
 //	if the interrupted thread called Yield at the point it is 
 //	was interrupted.
 //
-//	For now, just provide time-slicing.  Only need to time slice 
-//      if we're currently running something (in other words, not idle).
-//	Also, to keep from looping forever, we check if there's
-//	nothing on the ready list, and there are no other pending
-//	interrupts.  In this case, we can safely halt.
+//	First wake up the sleeping threads that are due, and release
+//	any real-time jobs.  Then time-slice, if the scheduler wants it.
+//	If there is nothing to time-slice, reprogram the timer to go off
+//	when the next sleeping thread is due -- or, if nobody is
+//	sleeping, turn it off; once there is nothing left to run and
+//	no other pending interrupts, Nachos can then halt.
 //----------------------------------------------------------------------
 
 void Alarm::CallBack() 
 {
     Interrupt *interrupt = kernel->interrupt;
     MachineStatus status = interrupt->getStatus();
-    bool indicator = (a_sleeping_space_for_threads.check_thread() == 0);
+    int now = kernel->stats->totalTicks;
+    Thread *thread, *next;
+
+    for (thread = sleepers->Advance(now / TimerTicks); thread != NULL;
+			thread = next) {
+	next = thread->sleepNext;
+	kernel->scheduler->ReadyToRun(thread);
+    }
+
+    kernel->scheduler->CheckRealTime();	// release due real-time jobs
 
-    if ( (indicator) && (a_sleeping_space_for_threads.vector_containing_sleeping_spaces.size() == 0) && (status == IdleMode) ) {	// is it time to quit?
-        if (!interrupt->AnyFutureInterrupts()) {
+    if (!NeedsTicks(status == IdleMode)) {	// go tickless
+	int when = sleepers->NextExpiry();
+
+	ticking = FALSE;
+	if (when < 0) {
 	    timer->Disable();	// turn off the timer
+	} else {
+	    timer->SetNext(when * TimerTicks - now);
 	}
     } else {			// there's someone to preempt
+        ticking = TRUE;
         SchedulerType type_ =  (*((*kernel).scheduler)).get_scheduler_type();
-        if (type_ == Priority) {
+        if (type_ == Priority || type_ == Lottery || type_ == Stride) {
             interrupt->YieldOnReturn();
         }
+        else if (type_ == MLFQ) {
+            Scheduler *scheduler = kernel->scheduler;
+            scheduler->Age();
+            if (status != IdleMode
+                    && scheduler->QuantumExpired(kernel->currentThread)) {
+                scheduler->Demote(kernel->currentThread);
+                interrupt->YieldOnReturn();
+            }
+        }
+        else if (type_ == CFS) {
+            if (status != IdleMode
+                    && kernel->scheduler->QuantumExpired(kernel->currentThread)) {
+                interrupt->YieldOnReturn();
+            }
+        }
     }
 }
-
@@ -8,6 +8,10 @@
 //	From this, we provide the ability for a thread to be
 //	woken up after a delay; we also provide time-slicing.
 //
+//	The timer only interrupts every period while the scheduler has
+//	something to time-slice.  Otherwise it is "tickless": it is set
+//	to go off when the next sleeping thread is due, or not at all.
+//
 //	NOTE: this abstraction is not completely implemented.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
@@ -22,47 +26,27 @@
 #include "callback.h"
 #include "timer.h"
 #include "thread.h"
-#include <vector>
-using namespace std;
-
-// Define a class, trying to put threads to sleep.
-class sleeping_space_for_threads {
-public:
-  sleeping_space_for_threads():now_time(0) {};
-
-  int now_time;
-
-  class sleeping_space {
-  public:
-    int time_to_wake_up;
-    Thread * thread_that_is_sleeping;
-    sleeping_space(int time_argument, Thread * thr):
-      thread_that_is_sleeping(thr), time_to_wake_up(time_argument) {};
-  };
-
-  void make_thread_to_sleep(int time_argument_, Thread * thr_);
-
-  int check_thread();
-
-  vector<sleeping_space> vector_containing_sleeping_spaces;
-
-};
-
-
+#include "timingwheel.h"
 
 // The following class defines a software alarm clock. 
 class Alarm : public CallBackObj {
   public:
     Alarm(bool doRandomYield);	// Initialize the timer, and callback 
 				// to "toCall" every time slice.
-    ~Alarm() { delete timer; }
+    ~Alarm() { delete timer; delete sleepers; }
     
     void WaitUntil(int x);	// suspend execution until time > now + x
-
-    sleeping_space_for_threads a_sleeping_space_for_threads;
+    void WaitNextPeriod();	// real-time thread: this job is done,
+				// wait for the next one to be released
+    void StartTicking();	// the CPU is busy again: go back to
+				// time-slicing, if the scheduler needs it
 
   private:
     Timer *timer;		// the hardware timer device
+    TimingWheel *sleepers;	// threads in WaitUntil, by wakeup period
+    bool ticking;		// is the timer interrupting every period?
+
+    bool NeedsTicks(bool idle);	// must the timer interrupt every period?
 
     void CallBack();		// called when the hardware
 				// timer generates an interrupt
@@ -27,6 +27,16 @@ using namespace std;
 ThreadedKernel::ThreadedKernel(int argc, char **argv)
 {
     randomSlice = FALSE; 
+    burstAlpha = DefaultBurstAlpha;
+    benchJobs = 0;
+    benchCpuBurst = 20;
+    benchIoBurst = 2;
+    benchBursts = 3;
+    benchDistribution = BenchUniform;
+    microIterations = 0;
+    microRepetitions = 5;
+    microWarmup = -1;
+    slabStats = FALSE;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-rs") == 0) {
  	    ASSERT(i + 1 < argc);
@@ -34,8 +44,50 @@ ThreadedKernel::ThreadedKernel(int argc, char **argv)
 					// number generator
 	    randomSlice = TRUE;
 	    i++;
+        } else if (strcmp(argv[i], "-alpha") == 0) {
+	    ASSERT(i + 1 < argc);
+	    burstAlpha = atof(argv[i + 1]);
+	    ASSERT(burstAlpha >= 0.0 && burstAlpha <= 1.0);
+	    i++;
+        } else if (strcmp(argv[i], "-sched-bench") == 0) {
+	    ASSERT(i + 1 < argc);
+	    benchJobs = atoi(argv[i + 1]);
+	    i++;
+        } else if (strcmp(argv[i], "-bench-cpu") == 0) {
+	    ASSERT(i + 1 < argc);
+	    benchCpuBurst = atoi(argv[i + 1]);
+	    i++;
+        } else if (strcmp(argv[i], "-bench-io") == 0) {
+	    ASSERT(i + 1 < argc);
+	    benchIoBurst = atoi(argv[i + 1]);
+	    i++;
+        } else if (strcmp(argv[i], "-bench-bursts") == 0) {
+	    ASSERT(i + 1 < argc);
+	    benchBursts = atoi(argv[i + 1]);
+	    i++;
+        } else if (strcmp(argv[i], "-bench-bimodal") == 0) {
+	    benchDistribution = BenchBimodal;
+        } else if (strcmp(argv[i], "-micro-bench") == 0) {
+	    ASSERT(i + 1 < argc);
+	    microIterations = atoi(argv[i + 1]);
+	    i++;
+        } else if (strcmp(argv[i], "-micro-reps") == 0) {
+	    ASSERT(i + 1 < argc);
+	    microRepetitions = atoi(argv[i + 1]);
+	    i++;
+        } else if (strcmp(argv[i], "-micro-warmup") == 0) {
+	    ASSERT(i + 1 < argc);
+	    microWarmup = atoi(argv[i + 1]);
+	    i++;
+        } else if (strcmp(argv[i], "-slab-stats") == 0) {
+	    slabStats = TRUE;
         } else if (strcmp(argv[i], "-u") == 0) {
-            cout << "Partial usage: nachos [-rs randomSeed]\n";
+            cout << "Partial usage: nachos [-rs randomSeed] [-alpha burstWeight]\n";
+            cout << "Partial usage: nachos [-sched-bench numJobs] [-bench-cpu meanBurst]\n";
+            cout << "\t[-bench-io meanWait] [-bench-bursts burstsPerJob] [-bench-bimodal]\n";
+            cout << "Partial usage: nachos [-micro-bench iterations] [-micro-reps repetitions]\n";
+            cout << "\t[-micro-warmup iterations]\n";
+            cout << "Partial usage: nachos [-slab-stats]\n";
 	}
     }
 }
@@ -58,6 +110,7 @@ ThreadedKernel::Initialize(SchedulerType ty)
     stats = new Statistics();		// collect statistics
     interrupt = new Interrupt;		// start up interrupt handling
     scheduler = new Scheduler(ty);	// initialize the ready queue
+    scheduler->SetBurstAlpha(burstAlpha);
     alarm = new Alarm(randomSlice);	// start up time slicing
 
     // We didn't explicitly allocate the current thread we are running in.
@@ -106,31 +159,90 @@ ThreadedKernel::Run()
 //----------------------------------------------------------------------
 // ThreadedKernel::SelfTest
 //      Test whether this module is working.
+//
+//	"testCase" is which of the scheduling test cases to run (1 for
+//	TestCase1, and so on), or 0 for none.
 //----------------------------------------------------------------------
 
 void
-ThreadedKernel::SelfTest(bool var1, bool var2) {
+ThreadedKernel::SelfTest(int testCase) {
    Semaphore *semaphore;
+   ReaderWriterLock *rwLock;
    SynchList<int> *synchList;
+   TimingWheel *wheel;
+   int period;
    
    LibSelfTest();		// test library routines
    
+   if (testCase == 0) {		// a sleep of no time at all lasts until
+   				// the next period (not with a test case,
+   				// whose timings it would shift)
+    period = stats->totalTicks / TimerTicks;
+    alarm->WaitUntil(0);
+    ASSERT(stats->totalTicks / TimerTicks > period);
+   }
+   
    currentThread->SelfTest();	// test thread switching
    
-   if (var1) {
-    cout << "Test case 1 is running. There are 5 threads: A1, A2, A3, A4, A5. " << endl;
-    Thread::testing_function_1();
+   if (microIterations > 0) {	// time the kernel primitives
+    MicroBenchmark *micro = new MicroBenchmark(microIterations,
+		microRepetitions,
+		(microWarmup < 0) ? microIterations / 10 : microWarmup);
+    micro->Run();
+    delete micro;
    }
-   else if (var2) {
-    cout << "Test case 2 is running. There are 4 threads: B1, B2, B3, B4. " << endl;
-    Thread::testing_function_2();
+   if (benchJobs > 0) {		// compare the scheduling policies
+    SchedulerBenchmark *bench = new SchedulerBenchmark(benchJobs,
+		benchCpuBurst, benchIoBurst, benchBursts, benchDistribution);
+    bench->Run();
+    delete bench;
+   }
+   else {
+    switch (testCase) {
+      case 1:
+	cout << "Test case 1 is running. There are 5 threads: A1, A2, A3, A4, A5. " << endl;
+	Thread::testing_function_1();
+	break;
+      case 2:
+	cout << "Test case 2 is running. There are 4 threads: B1, B2, B3, B4. " << endl;
+	Thread::testing_function_2();
+	break;
+      case 3:
+	cout << "Test case 3 is running. C1 is a long job; C2, a short one, becomes ready while C1 runs. " << endl;
+	Thread::testing_function_3();
+	break;
+      case 4:
+	cout << "Test case 4 is running. D1, D2, D3 hold 100, 200, 300 tickets. " << endl;
+	Thread::testing_function_4();
+	break;
+      case 5:
+	cout << "Test case 5 is running. R1, R2 are real-time threads; F1 is a batch job. " << endl;
+	Thread::testing_function_5();
+	break;
+      case 6:
+	cout << "Test case 6 is running. L, X, H hold locks with priorities 9, 7, 1; M1, M2 (priority 5) keep the CPU busy. " << endl;
+	Thread::testing_function_6();
+	break;
+      default:
+	break;
+    }
    }
 
    
+   				// test the timing wheel of sleepers
+   wheel = new TimingWheel(0);
+   wheel->SelfTest();
+   delete wheel;
+
    				// test semaphore operation
    semaphore = new Semaphore("test", 0);
    semaphore->SelfTest();
    delete semaphore;
+
+   				// test reader-writer locks
+   rwLock = new ReaderWriterLock("test");
+   rwLock->SelfTest();
+   delete rwLock;
    
    				// test locks, condition variables
 				// using synchronized lists
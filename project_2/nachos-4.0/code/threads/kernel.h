@@ -16,6 +16,8 @@
 #include "interrupt.h"
 #include "stats.h"
 #include "alarm.h"
+#include "schedbench.h"
+#include "microbench.h"
 
 class ThreadedKernel {
   public:
@@ -30,7 +32,8 @@ class ThreadedKernel {
 
     void Run();			// do kernel stuff
 				    
-    void SelfTest(bool var1, bool var2);		// test whether kernel is working
+    void SelfTest(int testCase = 0);	// test whether kernel is working,
+					// then run TestCase<testCase>, if any
     
 // These are public for notational convenience; really, 
 // they're global variables used everywhere.  Putting them into 
@@ -42,9 +45,23 @@ class ThreadedKernel {
     Interrupt *interrupt;	// interrupt status
     Statistics *stats;		// performance metrics
     Alarm *alarm;		// the software alarm clock    
+    bool slabStats;		// print the slab caches' usage at Halt
 
   private:
     bool randomSlice;		// enable pseudo-random time slicing
+    double burstAlpha;		// weight of the newest burst in the
+				// SJF burst prediction
+    int benchJobs;		// jobs in the scheduler benchmark;
+				// 0 means don't run it
+    int benchCpuBurst;		// mean CPU burst of a benchmark job
+    int benchIoBurst;		// mean I/O wait of a benchmark job
+    int benchBursts;		// CPU bursts per benchmark job
+    BenchDistribution benchDistribution;
+    int microIterations;	// operations per run of each micro-
+				// benchmark; 0 means don't run them
+    int microRepetitions;	// timed runs of each microbenchmark
+    int microWarmup;		// operations in the untimed run;
+				// -1 means a tenth of microIterations
 };
 
 
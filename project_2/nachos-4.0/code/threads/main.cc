@@ -78,6 +78,11 @@ main(int argc, char **argv)
     bool is_SJF = (strcmp(argv[1], "SJF") == 0);
     bool is_Priority = (strcmp(argv[1], "Priority") == 0);
     bool is_FCFS = (strcmp(argv[1], "FCFS") == 0);
+    bool is_MLFQ = (strcmp(argv[1], "MLFQ") == 0);
+    bool is_SRTF = (strcmp(argv[1], "SRTF") == 0);
+    bool is_CFS = (strcmp(argv[1], "CFS") == 0);
+    bool is_Lottery = (strcmp(argv[1], "Lottery") == 0);
+    bool is_Stride = (strcmp(argv[1], "Stride") == 0);
     if (is_SJF) {
         scheduling_type = SJF;
         cout << "CPU scheduling method is assigned as: SJF" <<endl;
@@ -90,10 +95,33 @@ main(int argc, char **argv)
         scheduling_type = FCFS;
         cout << "CPU scheduling method is assigned as: FCFS" <<endl;
     }
+    else if (is_MLFQ) {
+        scheduling_type = MLFQ;
+        cout << "CPU scheduling method is assigned as: MLFQ" <<endl;
+    }
+    else if (is_SRTF) {
+        scheduling_type = SRTF;
+        cout << "CPU scheduling method is assigned as: SRTF" <<endl;
+    }
+    else if (is_CFS) {
+        scheduling_type = CFS;
+        cout << "CPU scheduling method is assigned as: CFS" <<endl;
+    }
+    else if (is_Lottery) {
+        scheduling_type = Lottery;
+        cout << "CPU scheduling method is assigned as: Lottery" <<endl;
+    }
+    else if (is_Stride) {
+        scheduling_type = Stride;
+        cout << "CPU scheduling method is assigned as: Stride" <<endl;
+    }
 
 
-    bool is_test_case_1 = (strcmp(argv[2], "TestCase1") == 0);
-    bool is_test_case_2 = (strcmp(argv[2], "TestCase2") == 0);
+    //"TestCase1" .. "TestCase6" pick a test case; anything else, none.
+    int test_case = 0;
+    if (strncmp(argv[2], "TestCase", 8) == 0) {
+        test_case = atoi(argv[2] + 8);
+    }
 
 
     debug = new Debug(debugArg);
@@ -105,7 +133,7 @@ main(int argc, char **argv)
     
     CallOnUserAbort(Cleanup);		// if user hits ctl-C
 
-    kernel->SelfTest(is_test_case_1, is_test_case_2);
+    kernel->SelfTest(test_case);
     kernel->Run();
     
     return 0;
@@ -0,0 +1,400 @@
+// microbench.cc
+//	Routines to time the kernel's thread and synchronization
+//	primitives.  See microbench.h.
+//
+//	Each benchmark is a procedure that does "n" operations, with the
+//	help of threads it forks, and returns once they have all finished.
+//	The helpers' entries in the per-thread statistics are dropped as
+//	soon as they are gone, since a run forks thousands of them.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "microbench.h"
+#include "main.h"
+#include "synch.h"
+#include "synchlist.h"
+#include "sysdep.h"
+
+// Most helper threads a benchmark forks at a time.
+const int MaxHelpers = MicroWaiters;
+
+static Semaphore *helpersDone;		// V'ed by each helper as it finishes
+static ThreadStatistics *helperStats[MaxHelpers];
+static int numHelpers;
+
+// What the benchmarks share with their helpers.
+static Semaphore *ping, *pong;
+static Lock *lock;
+static Condition *cond, *allArrived;
+static int turn, generation, arrived;
+static SynchList<int> *synchList;
+
+//----------------------------------------------------------------------
+// Spawn
+// 	Fork a helper thread, to run "func(arg)".  The helper must call
+//	HelperDone as the last thing it does.
+//----------------------------------------------------------------------
+
+static void
+Spawn(VoidFunctionPtr func, int arg)
+{
+    Thread *t = new Thread("micro helper");
+
+    ASSERT(numHelpers < MaxHelpers);
+    helperStats[numHelpers++] = t->accounting;
+    t->Fork(func, (void *) arg);
+}
+
+//----------------------------------------------------------------------
+// HelperDone, WaitForHelpers
+// 	A helper tells the benchmark it is about to finish; the benchmark
+//	waits for all its helpers to do so.  The helper turns interrupts
+//	off first, so it cannot be preempted on its way to Thread::Finish:
+//	by the time the benchmark runs again, the helper has been deleted
+//	(by the thread it switched to), so its statistics can go too.
+//----------------------------------------------------------------------
+
+static void
+HelperDone()
+{
+    (void) kernel->interrupt->SetLevel(IntOff);	// Finish turns them on
+    helpersDone->V();				// in the next thread
+}
+
+static void
+WaitForHelpers()
+{
+    for (int i = 0; i < numHelpers; i++) {
+	helpersDone->P();
+    }
+    for (int i = 0; i < numHelpers; i++) {
+	kernel->stats->DropThread(helperStats[i]);
+    }
+    numHelpers = 0;
+}
+
+//----------------------------------------------------------------------
+// Yield
+// 	"n" times, yield to the other thread, which yields straight back.
+//----------------------------------------------------------------------
+
+static void
+YieldHelper(int n)
+{
+    for (int i = 0; i < n; i++) {
+	kernel->currentThread->Yield();
+    }
+    HelperDone();
+}
+
+static void
+BenchYield(int n)
+{
+    Spawn((VoidFunctionPtr) YieldHelper, n);
+    for (int i = 0; i < n; i++) {
+	kernel->currentThread->Yield();
+    }
+    WaitForHelpers();
+}
+
+//----------------------------------------------------------------------
+// SemPingPong
+// 	"n" times, V the other thread's semaphore, and P ours until it
+//	has V'ed it back.
+//----------------------------------------------------------------------
+
+static void
+SemHelper(int n)
+{
+    for (int i = 0; i < n; i++) {
+	ping->P();
+	pong->V();
+    }
+    HelperDone();
+}
+
+static void
+BenchSemPingPong(int n)
+{
+    ping = new Semaphore("micro ping", 0);
+    pong = new Semaphore("micro pong", 0);
+    Spawn((VoidFunctionPtr) SemHelper, n);
+    for (int i = 0; i < n; i++) {
+	ping->V();
+	pong->P();
+    }
+    WaitForHelpers();
+    delete ping;
+    delete pong;
+}
+
+//----------------------------------------------------------------------
+// LockFree
+// 	"n" times, acquire and release a lock nobody else wants.
+//----------------------------------------------------------------------
+
+static void
+BenchLockFree(int n)
+{
+    lock = new Lock("micro lock");
+    for (int i = 0; i < n; i++) {
+	lock->Acquire();
+	lock->Release();
+    }
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// LockContended
+// 	"n" times, acquire and release a lock, yielding while we hold it
+//	and after we let go of it, so that the other thread is always
+//	waiting for it when it is released, and holding it when we next
+//	try to acquire it.
+//----------------------------------------------------------------------
+
+static void
+LockLoop(int n)
+{
+    for (int i = 0; i < n; i++) {
+	lock->Acquire();
+	kernel->currentThread->Yield();
+	lock->Release();
+	kernel->currentThread->Yield();
+    }
+}
+
+static void
+LockHelper(int n)
+{
+    LockLoop(n);
+    HelperDone();
+}
+
+static void
+BenchLockContended(int n)
+{
+    lock = new Lock("micro lock");
+    Spawn((VoidFunctionPtr) LockHelper, n);
+    LockLoop(n);
+    WaitForHelpers();
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// CondSignal
+// 	"n" times, hand the turn to the other thread, signal it, and
+//	wait until it has handed the turn back.
+//----------------------------------------------------------------------
+
+static void
+SignalHelper(int n)
+{
+    lock->Acquire();
+    for (int i = 0; i < n; i++) {
+	while (turn == 0) {
+	    cond->Wait(lock);
+	}
+	turn = 0;
+	cond->Signal(lock);
+    }
+    lock->Release();
+    HelperDone();
+}
+
+static void
+BenchCondSignal(int n)
+{
+    lock = new Lock("micro lock");
+    cond = new Condition("micro cond");
+    turn = 0;
+    Spawn((VoidFunctionPtr) SignalHelper, n);
+    lock->Acquire();
+    for (int i = 0; i < n; i++) {
+	turn = 1;
+	cond->Signal(lock);
+	while (turn == 1) {
+	    cond->Wait(lock);
+	}
+    }
+    lock->Release();
+    WaitForHelpers();
+    delete cond;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// CondBroadcast
+// 	"n" times, start a new generation and broadcast it to the
+//	waiters, then wait until every one of them has seen it.
+//----------------------------------------------------------------------
+
+static void
+BroadcastHelper(int n)
+{
+    int seen = 0;
+
+    lock->Acquire();
+    for (int i = 0; i < n; i++) {
+	while (generation == seen) {
+	    cond->Wait(lock);
+	}
+	seen = generation;
+	if (++arrived == MicroWaiters) {
+	    allArrived->Signal(lock);
+	}
+    }
+    lock->Release();
+    HelperDone();
+}
+
+static void
+BenchCondBroadcast(int n)
+{
+    lock = new Lock("micro lock");
+    cond = new Condition("micro cond");
+    allArrived = new Condition("micro all arrived");
+    generation = 0;
+    for (int i = 0; i < MicroWaiters; i++) {
+	Spawn((VoidFunctionPtr) BroadcastHelper, n);
+    }
+    lock->Acquire();
+    for (int i = 0; i < n; i++) {
+	arrived = 0;
+	generation++;
+	cond->Broadcast(lock);
+	while (arrived < MicroWaiters) {
+	    allArrived->Wait(lock);
+	}
+    }
+    lock->Release();
+    WaitForHelpers();
+    delete allArrived;
+    delete cond;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// SynchList
+// 	Take "n" items off a list that the other thread puts them on.
+//----------------------------------------------------------------------
+
+static void
+ProducerHelper(int n)
+{
+    for (int i = 0; i < n; i++) {
+	synchList->Append(i);
+    }
+    HelperDone();
+}
+
+static void
+BenchSynchList(int n)
+{
+    synchList = new SynchList<int>;
+    Spawn((VoidFunctionPtr) ProducerHelper, n);
+    for (int i = 0; i < n; i++) {
+	ASSERT(synchList->RemoveFront() == i);
+    }
+    WaitForHelpers();
+    delete synchList;
+}
+
+//----------------------------------------------------------------------
+// ForkFinish
+// 	"n" times, fork a thread that finishes straight away, and wait
+//	for it to be gone.
+//----------------------------------------------------------------------
+
+static void
+NullHelper(int n)
+{
+    HelperDone();
+}
+
+static void
+BenchForkFinish(int n)
+{
+    for (int i = 0; i < n; i++) {
+	Spawn((VoidFunctionPtr) NullHelper, 0);
+	WaitForHelpers();
+    }
+}
+
+//----------------------------------------------------------------------
+// MicroBenchmark::MicroBenchmark
+// 	Set up the suite.
+//
+//	"iterations" -- how many operations each timed run does
+//	"repetitions" -- how many timed runs of each benchmark
+//	"warmup" -- how many operations in the untimed run; 0 for none
+//----------------------------------------------------------------------
+
+MicroBenchmark::MicroBenchmark(int iterations, int repetitions, int warmup)
+{
+    ASSERT(iterations > 0 && repetitions > 0 && warmup >= 0);
+    this->iterations = iterations;
+    this->repetitions = repetitions;
+    this->warmup = warmup;
+}
+
+//----------------------------------------------------------------------
+// MicroBenchmark::Run
+// 	Run every benchmark in turn.
+//----------------------------------------------------------------------
+
+void
+MicroBenchmark::Run()
+{
+    cout << "# micro,name,repetitions,iterations,min ns/op,mean ns/op,max ns/op\n";
+    helpersDone = new Semaphore("micro helpers done", 0);
+    numHelpers = 0;
+    Measure("Yield", BenchYield);
+    Measure("SemPingPong", BenchSemPingPong);
+    Measure("LockFree", BenchLockFree);
+    Measure("LockContended", BenchLockContended);
+    Measure("CondSignal", BenchCondSignal);
+    Measure("CondBroadcast", BenchCondBroadcast);
+    Measure("SynchList", BenchSynchList);
+    Measure("ForkFinish", BenchForkFinish);
+    delete helpersDone;
+    helpersDone = NULL;
+}
+
+//----------------------------------------------------------------------
+// MicroBenchmark::Measure
+// 	Warm up, then time "repetitions" runs of "body", and print the
+//	fastest, mean and slowest time per operation.
+//
+//	"name" -- the name of the benchmark, for the record
+//	"body" -- does "n" operations
+//----------------------------------------------------------------------
+
+void
+MicroBenchmark::Measure(char *name, void (*body)(int n))
+{
+    double fastest = 0, slowest = 0, total = 0;
+
+    if (warmup > 0) {
+	(*body)(warmup);
+    }
+    for (int r = 0; r < repetitions; r++) {
+	double start = HostTime();
+	double perOp;
+
+	(*body)(iterations);
+	perOp = (HostTime() - start) / iterations;
+	if (r == 0 || perOp < fastest) {
+	    fastest = perOp;
+	}
+	if (r == 0 || perOp > slowest) {
+	    slowest = perOp;
+	}
+	total += perOp;
+    }
+    cout << "micro," << name << "," << repetitions << "," << iterations
+	 << "," << fastest << "," << total / repetitions << "," << slowest
+	 << "\n";
+}
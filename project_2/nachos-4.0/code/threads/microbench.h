@@ -0,0 +1,61 @@
+// microbench.h
+//	Microbenchmarks for the kernel's thread and synchronization
+//	primitives: how much host time each operation takes.
+//
+//	Each benchmark runs an operation "iterations" times; it is run
+//	once untimed, "warmup" iterations long, to warm up the host's
+//	caches and the stack pool, then "repetitions" times timed.  The
+//	operations measured are:
+//
+//	    Yield	   -- Thread::Yield between two threads (one SWITCH)
+//	    SemPingPong	   -- Semaphore V/P round trip between two threads
+//	    LockFree	   -- Lock::Acquire and Release, uncontended
+//	    LockContended  -- Lock::Acquire and Release, with the other
+//			      thread always holding or waiting for the lock
+//	    CondSignal	   -- Condition::Signal/Wait round trip
+//	    CondBroadcast  -- Condition::Broadcast to MicroWaiters threads,
+//			      until they have all woken up
+//	    SynchList	   -- SynchList Append and RemoveFront, between
+//			      a producer and a consumer
+//	    ForkFinish	   -- Thread::Fork of a thread that just finishes
+//
+//	The results are in host nanoseconds per operation, one comma
+//	separated record per benchmark, so they can be picked out of the
+//	rest of the Nachos output with grep:
+//
+//	    micro,<name>,<repetitions>,<iterations>,<min>,<mean>,<max>
+//
+//	Nachos time-slices as usual while the benchmarks run, so the
+//	numbers include the cost of the simulated timer, and depend on
+//	the scheduling policy.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include "copyright.h"
+
+// How many threads wait on the condition in CondBroadcast.
+const int MicroWaiters = 4;
+
+// The following class defines the microbenchmark suite.
+
+class MicroBenchmark {
+  public:
+    MicroBenchmark(int iterations, int repetitions, int warmup);
+				// set up the suite
+    void Run();			// run every benchmark, and report on each
+
+  private:
+    int iterations;		// operations per timed run
+    int repetitions;		// timed runs per benchmark
+    int warmup;			// operations in the untimed run
+
+    void Measure(char *name, void (*body)(int n));
+				// time "body", and print its record
+};
+
+#endif // MICROBENCH_H
@@ -0,0 +1,140 @@
+// runqueue.cc
+//	Routines to manage a constant time ready queue: an array of
+//	FIFO lists indexed by key, plus a bitmap of the non-empty lists.
+//	See runqueue.h for details.
+//
+//	NOTE: Mutual exclusion must be provided by the caller; the
+//	scheduler always calls us with interrupts disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "runqueue.h"
+#include "sysdep.h"
+
+//----------------------------------------------------------------------
+// RunQueue::RunQueue
+// 	Initialize a ready queue, empty to start with.
+//----------------------------------------------------------------------
+
+RunQueue::RunQueue()
+{
+    for (int i = 0; i < RunQueueMapWords; i++) {
+	map[i] = 0;
+    }
+    numInQueue = 0;
+}
+
+//----------------------------------------------------------------------
+// RunQueue::~RunQueue
+// 	Prepare a ready queue for deallocation.  Any threads still on
+//	it are taken off as each level is deleted.  (When Nachos halts,
+//	threads may still be ready to run.)
+//----------------------------------------------------------------------
+
+RunQueue::~RunQueue()
+{
+}
+
+//----------------------------------------------------------------------
+// RunQueue::KeyToLevel
+// 	Map a key onto a queue level.  Every priority has a level of
+//	its own.
+//----------------------------------------------------------------------
+
+int
+RunQueue::KeyToLevel(int key)
+{
+    ASSERT(key >= MinPriority && key <= MaxPriority);
+    return key - MinPriority;
+}
+
+//----------------------------------------------------------------------
+// RunQueue::Insert
+//      Put "thread" at the end of the list for its level, and mark
+//	the level as non-empty.
+//
+//	"thread" is the thread to put on the queue.
+//	"key" is what it is ordered by -- smaller keys come out first.
+//----------------------------------------------------------------------
+
+void
+RunQueue::Insert(Thread *thread, int key)
+{
+    int level = KeyToLevel(key);
+
+    if (levels[level].IsEmpty()) {
+	map[level / BitsInWord] |= 1u << (level % BitsInWord);
+    }
+    levels[level].Append(thread);
+    numInQueue++;
+}
+
+//----------------------------------------------------------------------
+// RunQueue::RemoveFront
+//      Remove the first thread of the lowest non-empty level.
+//
+// Returns:
+//	The removed thread, or NULL if the queue is empty.
+//----------------------------------------------------------------------
+
+Thread *
+RunQueue::RemoveFront()
+{
+    Thread *thread;
+    int level;
+
+    for (int i = 0; i < RunQueueMapWords; i++) {
+	if (map[i] != 0) {
+	    level = i * BitsInWord + ffs(map[i]) - 1;
+
+	    thread = levels[level].RemoveFront();
+	    if (levels[level].IsEmpty()) {
+		map[i] &= ~(1u << (level % BitsInWord));
+	    }
+	    numInQueue--;
+	    return thread;
+	}
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// RunQueue::Remove
+//      Take a specific thread off the queue, for instance because its
+//	key is about to change.
+//
+//	"thread" is the thread to remove; it must be on the queue.
+//	"key" is the key it was put on the queue with.
+//----------------------------------------------------------------------
+
+void
+RunQueue::Remove(Thread *thread, int key)
+{
+    int level = KeyToLevel(key);
+
+    levels[level].Remove(thread);	// thread must be on its level
+    if (levels[level].IsEmpty()) {
+	map[level / BitsInWord] &= ~(1u << (level % BitsInWord));
+    }
+    numInQueue--;
+}
+
+//----------------------------------------------------------------------
+// RunQueue::Apply
+//      Apply a function to every thread on the queue, in the order
+//	they would be removed.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+void
+RunQueue::Apply(void (*func)(Thread *))
+{
+    for (int level = 0; level < NumRunQueueLevels; level++) {
+	levels[level].Apply(func);
+    }
+}
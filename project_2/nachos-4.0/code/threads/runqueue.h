@@ -0,0 +1,63 @@
+// runqueue.h
+//	Data structures for a constant time ready queue, ordered by an
+//	integer key (a priority).
+//
+//	The queue is an array of FIFO lists, one per key, plus a bitmap
+//	with one bit per level telling which lists are non-empty.  Finding
+//	the best thread is then a find-first-set on the bitmap, rather than
+//	a walk down a sorted list.  Threads with the same level come out
+//	in the order they went in.
+//
+//	Each level is a ThreadQueue, linked through the Thread itself (a
+//	thread is on at most one queue at a time), so no memory is
+//	allocated on insert, and a thread can be taken off from the
+//	middle of its level without a walk to find it.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef RUNQUEUE_H
+#define RUNQUEUE_H
+
+#include "copyright.h"
+#include "bitmap.h"
+#include "thread.h"
+
+// Number of distinct levels: one for each priority, so threads are
+// ordered exactly.  Keys with no fixed bound (such as predicted
+// bursts) do not belong on a RunQueue.
+
+const int NumRunQueueLevels = MaxPriority - MinPriority + 1;
+const int RunQueueMapWords = NumRunQueueLevels / BitsInWord;
+
+// The following class defines a ready queue in which a smaller key
+// is always removed before a larger one.
+
+class RunQueue {
+  public:
+    RunQueue();			// initialize an empty queue
+    ~RunQueue();		// de-allocate the queue
+
+    void Insert(Thread *thread, int key);
+				// put thread at the end of its level
+    Thread *RemoveFront();	// take the thread with the smallest key
+				// off the queue; NULL if empty
+    void Remove(Thread *thread, int key);
+				// take thread, queued with key, off
+				// the queue
+    bool IsEmpty() { return numInQueue == 0; }
+    int NumInQueue() { return numInQueue; }
+    void Apply(void (*func)(Thread *));
+				// apply func to every thread, in order
+
+    static int KeyToLevel(int key);
+				// which level does key fall into?
+
+  private:
+    ThreadQueue levels[NumRunQueueLevels];	// FIFO list for each level
+    unsigned int map[RunQueueMapWords];	// bit i set iff level i non-empty
+    int numInQueue;			// total number of threads queued
+};
+
+#endif // RUNQUEUE_H
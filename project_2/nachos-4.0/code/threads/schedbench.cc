@@ -0,0 +1,295 @@
+// schedbench.cc
+//	Routines to run a made-up workload under each CPU scheduling
+//	policy, and report how each one did.  See schedbench.h.
+//
+//	Between runs, the kernel's scheduler is thrown away and a new
+//	one, for the next policy, is put in its place; this is safe
+//	because by then every job has finished, and the only thread
+//	left is the one running the benchmark.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "schedbench.h"
+#include "main.h"
+#include "synch.h"
+#include "sysdep.h"
+
+// Names of the policies, in the order of SchedulerType.
+static char *policyNames[] = { "RR", "SJF", "Priority", "FCFS", "MLFQ",
+			"SRTF", "CFS", "Lottery", "Stride" };
+
+static SchedulerBenchmark *bench;	// the benchmark being run
+static Semaphore *jobsDone;		// V'ed by each job as it finishes
+
+//----------------------------------------------------------------------
+// BenchJobThread
+// 	The procedure forked for each job.
+//----------------------------------------------------------------------
+
+static void
+BenchJobThread(int which)
+{
+    bench->RunJob(which);
+    jobsDone->V();
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::SchedulerBenchmark
+// 	Make up a workload.  The jobs arrive up to two timer periods
+//	apart, and each has "burstsPerJob" CPU bursts with an I/O wait
+//	between each pair.  The workload is drawn with RandomNumber, so
+//	"-rs" gives a different one.
+//
+//	"numJobs" -- how many jobs
+//	"meanCpuBurst" -- mean CPU burst, in units of OneTick
+//	"meanIoBurst" -- mean I/O wait, in timer periods; 0 for none
+//	"burstsPerJob" -- how many CPU bursts each job has
+//	"dist" -- how the burst lengths are spread around the means
+//----------------------------------------------------------------------
+
+SchedulerBenchmark::SchedulerBenchmark(int numJobs, int meanCpuBurst,
+	int meanIoBurst, int burstsPerJob, BenchDistribution dist)
+{
+    int arrival = 0;
+
+    ASSERT(numJobs > 0 && meanCpuBurst > 0 && meanIoBurst >= 0);
+    ASSERT(burstsPerJob > 0 && burstsPerJob <= MaxBenchBursts);
+
+    this->numJobs = numJobs;
+    distribution = dist;
+    jobs = new BenchJob[numJobs];
+    for (int i = 0; i < numJobs; i++) {
+	BenchJob *job = &jobs[i];
+
+	snprintf(job->name, sizeof(job->name), "J%d", i);
+	job->arrivalTime = arrival;
+	arrival += RandomNumber() % (2 * TimerTicks + 1);
+	job->priority = RandomNumber() % 10;
+	job->numBursts = burstsPerJob;
+	for (int b = 0; b < burstsPerJob; b++) {
+	    job->cpuBurst[b] = Draw(meanCpuBurst);
+	    job->ioBurst[b] = (b < burstsPerJob - 1) ? Draw(meanIoBurst) : 0;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::~SchedulerBenchmark
+// 	De-allocate the workload.
+//----------------------------------------------------------------------
+
+SchedulerBenchmark::~SchedulerBenchmark()
+{
+    delete [] jobs;
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::Draw
+// 	Return a burst length whose mean is "mean" (0 if "mean" is 0).
+//----------------------------------------------------------------------
+
+int
+SchedulerBenchmark::Draw(int mean)
+{
+    if (mean == 0) {
+	return 0;
+    }
+    if (distribution == BenchUniform) {
+	return 1 + RandomNumber() % (2 * mean - 1);
+    }
+    // bimodal: 80% short ones, averaging about mean/2, and 20% long
+    // ones, averaging 3 * mean
+    if (RandomNumber() % 5 != 0) {
+	return 1 + RandomNumber() % mean;
+    }
+    return 2 * mean + RandomNumber() % (2 * mean + 1);
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::Run
+// 	Run the workload under every scheduling policy, then go back to
+//	the policy we started with.
+//----------------------------------------------------------------------
+
+void
+SchedulerBenchmark::Run()
+{
+    SchedulerType original = kernel->scheduler->get_scheduler_type();
+
+    cout << "# job,policy,name,arrival,cpu,io,turnaround,waiting,response,dispatches\n";
+    cout << "# policy,policy,jobs,turnaround,waiting,response,switches,preemptions,ticks\n";
+    bench = this;
+    jobsDone = new Semaphore("bench jobs done", 0);
+    for (int type = RR; type <= Stride; type++) {
+	RunPolicy((SchedulerType) type);
+    }
+    delete jobsDone;
+    jobsDone = NULL;
+    bench = NULL;
+    UseScheduler(original);
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::UseScheduler
+// 	Replace the kernel's scheduler with a new one, of type "type",
+//	moving over any threads still on the old one's ready list (the
+//	benchmark may start before the other self tests are done).
+//----------------------------------------------------------------------
+
+void
+SchedulerBenchmark::UseScheduler(SchedulerType type)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Scheduler *old = kernel->scheduler;
+    Thread *current = kernel->currentThread;
+    ThreadStatus status = current->getStatus();
+    Thread *thread;
+
+    kernel->scheduler = new Scheduler(type);
+    kernel->scheduler->SetBurstAlpha(old->GetBurstAlpha());
+
+    current->setStatus(BLOCKED);	// so the old scheduler does not
+					// pick us to keep the CPU
+    while ((thread = old->FindNextToRun()) != NULL) {
+	kernel->scheduler->ReadyToRun(thread);
+    }
+    current->setStatus(status);
+    old->CheckToBeDestroyed();
+    delete old;
+    kernel->alarm->StartTicking();	// the new policy may time-slice
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::RunPolicy
+// 	Fork a thread for every job, wait for them all to finish, and
+//	report on how they did.
+//----------------------------------------------------------------------
+
+void
+SchedulerBenchmark::RunPolicy(SchedulerType type)
+{
+    int switches, preemptions;
+    IntStatus oldLevel;
+
+    UseScheduler(type);
+    start = kernel->stats->totalTicks;
+    switches = kernel->stats->numContextSwitches;
+    preemptions = kernel->stats->numPreemptions;
+
+    nextJob = 0;
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    CallBack();				// the first job arrives now
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    for (int i = 0; i < numJobs; i++) {
+	jobsDone->P();
+    }
+
+    Report(type, kernel->stats->numContextSwitches - switches,
+	   kernel->stats->numPreemptions - preemptions,
+	   kernel->stats->totalTicks - start);
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::CallBack
+// 	Interrupt handler: fork every job whose arrival time has come,
+//	then arrange to be called again when the next one is due.
+//----------------------------------------------------------------------
+
+void
+SchedulerBenchmark::CallBack()
+{
+    int now = kernel->stats->totalTicks - start;
+
+    while (nextJob < numJobs && jobs[nextJob].arrivalTime <= now) {
+	BenchJob *job = &jobs[nextJob];
+	Thread *t = new Thread(job->name);
+	int burst = 0;
+
+	// tell SJF the truth about our first burst: the CPU time
+	// until we first wait for I/O
+	for (int b = 0; b < job->numBursts; b++) {
+	    burst += job->cpuBurst[b] * SystemTick;
+	    if (job->ioBurst[b] > 0) {
+		break;
+	    }
+	}
+	t->set_priority(job->priority);
+	t->set_predicted_burst_time(burst);
+	job->arrival = now;
+	t->Fork((VoidFunctionPtr) BenchJobThread, (void *) nextJob);
+	nextJob++;
+    }
+    if (nextJob < numJobs) {
+	kernel->interrupt->Schedule(this, jobs[nextJob].arrivalTime - now,
+				    TimerInt);
+    }
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::RunJob
+// 	The body of job "which": run our CPU bursts, waiting for "I/O"
+//	after each but the last.
+//----------------------------------------------------------------------
+
+void
+SchedulerBenchmark::RunJob(int which)
+{
+    BenchJob *job = &jobs[which];
+    Thread *thread = kernel->currentThread;
+
+    job->firstRun = kernel->stats->totalTicks - start;
+    job->cpuTicks = job->ioTicks = 0;
+
+    for (int b = 0; b < job->numBursts; b++) {
+	for (int i = 0; i < job->cpuBurst[b]; i++) {
+	    kernel->interrupt->OneTick();
+	    job->cpuTicks += SystemTick;
+	}
+	if (job->ioBurst[b] > 0) {
+	    int blocked = kernel->stats->totalTicks;
+
+	    kernel->alarm->WaitUntil(job->ioBurst[b]);
+	    job->ioTicks += thread->readyTime - blocked;
+	}
+    }
+    job->finish = kernel->stats->totalTicks - start;
+    job->dispatches = thread->numDispatches;
+}
+
+//----------------------------------------------------------------------
+// SchedulerBenchmark::Report
+// 	Print a record for every job, and one with the averages for the
+//	policy.  Waiting time is whatever part of the turnaround time
+//	the job spent neither running nor blocked.
+//----------------------------------------------------------------------
+
+void
+SchedulerBenchmark::Report(SchedulerType type, int switches,
+			   int preemptions, int ticks)
+{
+    int totalTurnaround = 0, totalWaiting = 0, totalResponse = 0;
+
+    for (int i = 0; i < numJobs; i++) {
+	BenchJob *job = &jobs[i];
+	int turnaround = job->finish - job->arrival;
+	int waiting = turnaround - job->cpuTicks - job->ioTicks;
+	int response = job->firstRun - job->arrival;
+
+	cout << "job," << policyNames[type] << "," << job->name << ","
+	     << job->arrival << "," << job->cpuTicks << "," << job->ioTicks
+	     << "," << turnaround << "," << waiting << "," << response
+	     << "," << job->dispatches << "\n";
+	totalTurnaround += turnaround;
+	totalWaiting += waiting;
+	totalResponse += response;
+    }
+    cout << "policy," << policyNames[type] << "," << numJobs << ","
+	 << (double) totalTurnaround / numJobs << ","
+	 << (double) totalWaiting / numJobs << ","
+	 << (double) totalResponse / numJobs << "," << switches << ","
+	 << preemptions << "," << ticks << "\n";
+}
@@ -0,0 +1,101 @@
+// schedbench.h
+//	A workload generator for comparing the CPU scheduling policies.
+//
+//	The benchmark makes up a set of jobs, each of which arrives at
+//	some time, then alternates CPU bursts with I/O waits.  The same
+//	jobs are then run under every SchedulerType in turn, and for each
+//	job we report its turnaround time (arrival to finish), waiting
+//	time (time spent on the ready list), response time (arrival to
+//	first run) and how many times it was given the CPU, followed by
+//	the averages and the number of context switches for the policy.
+//
+//	The output is one comma separated record per line, so that it
+//	can be picked out of the rest of the Nachos output with grep:
+//
+//	    job,<policy>,<name>,<arrival>,<cpu>,<io>,<turnaround>,<waiting>,
+//		<response>,<dispatches>
+//	    policy,<policy>,<jobs>,<avg turnaround>,<avg waiting>,
+//		<avg response>,<context switches>,<preemptions>,<ticks>
+//
+//	All times are in ticks, and arrivals are counted from the start
+//	of the run.  Jobs are forked from an interrupt handler at their
+//	arrival times, so that when they arrive does not depend on the
+//	policy.  CPU bursts are done with Interrupt::OneTick (SystemTick
+//	ticks each), and I/O waits with Alarm::WaitUntil (whole timer
+//	periods).
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDBENCH_H
+#define SCHEDBENCH_H
+
+#include "copyright.h"
+#include "callback.h"
+#include "scheduler.h"
+
+// Most CPU bursts a job can have.
+const int MaxBenchBursts = 16;
+
+// How the lengths of the CPU bursts and I/O waits are drawn around
+// their means.  Bimodal gives mostly short bursts with a few long
+// ones (a mix of interactive and batch jobs); uniform spreads them
+// evenly between 1 and twice the mean.
+
+enum BenchDistribution { BenchUniform, BenchBimodal };
+
+// One job of the workload, with what we measured when it last ran.
+
+class BenchJob {
+  public:
+    char name[8];		// "J0", "J1", ...
+    int arrivalTime;		// ticks from the start of the run
+    int priority;		// for Priority, and as the CFS nice value
+    int numBursts;
+    int cpuBurst[MaxBenchBursts];	// in units of OneTick
+    int ioBurst[MaxBenchBursts];	// in timer periods, after each
+					// CPU burst but the last
+
+    int arrival;		// when we were forked
+    int firstRun;		// when we first got the CPU
+    int finish;			// when we were done
+    int cpuTicks;		// CPU time used
+    int ioTicks;		// time spent waiting for "I/O"
+    int dispatches;		// how many times we were given the CPU
+};
+
+// The following class defines the benchmark: a workload, and the
+// means to run it under each scheduling policy.
+
+class SchedulerBenchmark : public CallBackObj {
+  public:
+    SchedulerBenchmark(int numJobs, int meanCpuBurst, int meanIoBurst,
+		       int burstsPerJob, BenchDistribution dist);
+				// make up the workload
+    ~SchedulerBenchmark();
+
+    void Run();			// run the workload under every policy,
+				// and report on each
+    void RunJob(int which);	// body of job "which" (called by the
+				// thread running it)
+    void CallBack();		// interrupt handler: fork the jobs
+				// that have arrived
+
+  private:
+    int numJobs;
+    BenchJob *jobs;
+    BenchDistribution distribution;
+    int start;			// when the current run started
+    int nextJob;		// next job to arrive
+
+    int Draw(int mean);		// a burst length, around "mean"
+    void UseScheduler(SchedulerType type);
+				// replace the scheduler with a new one
+    void RunPolicy(SchedulerType type);
+				// run the workload under one policy
+    void Report(SchedulerType type, int switches, int preemptions,
+		int ticks);	// print the results of a run
+};
+
+#endif // SCHEDBENCH_H
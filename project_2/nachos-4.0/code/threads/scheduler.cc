@@ -32,43 +32,57 @@ using namespace std;
 
 
 //To compare different threads by various means, I need some "different" comparing functions.
-//First, a comparing function is designed for FCFS scheduling.
-int comparing_function_FCFS(Thread * thr_1, Thread * thr_2) {
-    return 1;
-}
+//FCFS does not need one: its threads go on the end of a ThreadQueue, in
+//the order they become ready, just as for RR.
 
-//Second, a comparing function is designed for Priority scheduling.
-int comparing_function_Priority(Thread * thr_1, Thread * thr_2) {
-    bool bigger_ = ((*thr_1).priority_of_the_thread > (*thr_2).priority_of_the_thread);
-    bool equal_ = ((*thr_1).priority_of_the_thread == (*thr_2).priority_of_the_thread);
-    bool smaller_ = ((*thr_1).priority_of_the_thread < (*thr_2).priority_of_the_thread);
-    if (bigger_) {
-        return 1;
-    }
-    else if (equal_) {
-        return 0;
-    }
-    else {
-        return -1;
+//Priority scheduling does not need one either: its threads go on a
+//RunQueue, keyed by the value returned from Scheduler::ReadyKey.
+
+//SJF and SRTF keep their ready threads on a Heap, ordered exactly by
+//the key they were queued with; threads with equal keys come out in
+//the order they were queued, as on a FIFO.
+static int
+CompareReadyKey(Thread *x, Thread *y)
+{
+    if (x->readyKey != y->readyKey) {
+        return (x->readyKey < y->readyKey) ? -1 : 1;
     }
+    if (x->readySeq < y->readySeq) { return -1; }
+    else if (x->readySeq == y->readySeq) { return 0; }
+    else { return 1; }
 }
 
-//Third, a comparing function is designed for SJF scheduling.
-int comparing_function_SJF(Thread * thr_1, Thread * thr_2) {
-    bool bigger_ = ((*thr_1).predicted_burst_time_of_the_thread > (*thr_2).predicted_burst_time_of_the_thread);
-    bool equal_ = ((*thr_1).predicted_burst_time_of_the_thread == (*thr_2).predicted_burst_time_of_the_thread);
-    bool smaller_ = ((*thr_1).predicted_burst_time_of_the_thread < (*thr_2).predicted_burst_time_of_the_thread);
-    if (bigger_) {
-        return 1;
-    }
-    else if (equal_) {
-        return 0;
-    }
-    else {
-        return -1;
-    }
+//CFS and Stride keep their ready threads on a Heap, ordered by virtual
+//runtime (for Stride, the pass).
+static int
+CompareVruntime(Thread *x, Thread *y)
+{
+    if (x->vruntime < y->vruntime) { return -1; }
+    else if (x->vruntime == y->vruntime) { return 0; }
+    else { return 1; }
 }
 
+//Real-time threads are kept on a Heap, ordered by absolute deadline.
+static int
+CompareDeadline(Thread *x, Thread *y)
+{
+    if (x->rtAbsDeadline < y->rtAbsDeadline) { return -1; }
+    else if (x->rtAbsDeadline == y->rtAbsDeadline) { return 0; }
+    else { return 1; }
+}
+
+//CFS weight of each nice value from -20 to 19; each step is a factor
+//of about 1.25, and nice 0 is CFSNice0Weight.  Same table as Linux.
+static const int cfsNiceToWeight[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15
+};
 
 Scheduler::Scheduler()
 {
@@ -78,18 +92,51 @@ Scheduler::Scheduler()
 //
 Scheduler::Scheduler(SchedulerType scheduling_type) {
     schedulerType = scheduling_type;
-    if (schedulerType == SJF) {
-        readyList = new SortedList<Thread *>(comparing_function_SJF);
-        cout << "readyList is assigned as SortedList<Thread *>(comparing_function_SJF) (pointer-wise)." <<endl;
+    runQueue = NULL;
+    burstHeap = NULL;
+    vruntimeHeap = NULL;
+    if (schedulerType == Priority) {
+        readyList = NULL;
+        runQueue = new RunQueue;
+        cout << "readyList is replaced by a RunQueue keyed by priority." <<endl;
     }
-    else if (schedulerType == Priority) {
-        readyList = new SortedList<Thread *>(comparing_function_Priority);
-        cout << "readyList is assigned as SortedList<Thread *>(comparing_function_Priority) (pointer-wise)." <<endl;
+    else if (schedulerType == SJF || schedulerType == SRTF) {
+        readyList = NULL;
+        burstHeap = new Heap<Thread *>(CompareReadyKey);
+        cout << "readyList is replaced by Heap<Thread *>(CompareReadyKey), keyed by " << ((schedulerType == SJF) ? "predicted" : "remaining") << " burst time." <<endl;
     }
     else if(schedulerType == FCFS) {
-        readyList = new SortedList<Thread *>(comparing_function_FCFS);
-        cout << "readyList is assigned as SortedList<Thread *>(comparing_function_FCFS) (pointer-wise)." <<endl;
+        readyList = new ThreadQueue;
+        cout << "readyList is assigned as ThreadQueue (FIFO, linked through the threads)." <<endl;
+    }
+    else if (schedulerType == CFS || schedulerType == Stride) {
+        readyList = NULL;
+        vruntimeHeap = new Heap<Thread *>(CompareVruntime);
+        cout << "readyList is replaced by Heap<Thread *>(CompareVruntime)." <<endl;
+    }
+    else if (schedulerType == MLFQ) {
+        readyList = NULL;
+        for (int i = 0; i < NumMLFQLevels; i++) {
+            mlfqQueues[i] = new ThreadQueue;
+        }
+        cout << "readyList is replaced by " << NumMLFQLevels << " MLFQ queues (ThreadQueue)." <<endl;
+    }
+    else {
+        readyList = new ThreadQueue;
+    }
+    if (schedulerType != MLFQ) {
+        for (int i = 0; i < NumMLFQLevels; i++) {
+            mlfqQueues[i] = NULL;
+        }
     }
+    realTimeHeap = new Heap<Thread *>(CompareDeadline);
+    realTimeThreads = new List<Thread *>;
+    rtUtilization = 0.0;
+    lastAging = 0;
+    minVruntime = 0;
+    cfsLoad = 0;
+    numQueued = 0;
+    burstAlpha = DefaultBurstAlpha;
     toBeDestroyed = NULL;
 }
 
@@ -103,6 +150,14 @@ Scheduler::Scheduler(SchedulerType scheduling_type) {
 Scheduler::~Scheduler()
 { 
     delete readyList; 
+    delete runQueue;
+    delete burstHeap;
+    delete vruntimeHeap;
+    delete realTimeHeap;
+    delete realTimeThreads;
+    for (int i = 0; i < NumMLFQLevels; i++) {
+        delete mlfqQueues[i];
+    }
 } 
 
 //----------------------------------------------------------------------
@@ -119,10 +174,114 @@ Scheduler::ReadyToRun (Thread *thread)
     ASSERT(kernel->interrupt->getLevel() == IntOff);
     DEBUG(dbgThread, "Putting thread on ready list: " << thread->getName());
 
+    thread->readyTime = kernel->stats->totalTicks;
+    if (thread->getStatus() == BLOCKED) {
+        thread->accounting->blockedTicks += thread->readyTime - thread->blockedTime;
+    }
+    if (thread->rtPeriod > 0) {
+        Thread *current = kernel->currentThread;
+
+        thread->setStatus(READY);
+        realTimeHeap->Insert(thread);
+        // a real-time job preempts any normal thread, and any
+        // real-time thread with a later deadline
+        if (thread != current && current->getStatus() == RUNNING
+                && (current->rtPeriod == 0
+                    || thread->rtAbsDeadline < current->rtAbsDeadline)) {
+            kernel->interrupt->Preempt();
+        }
+        return;
+    }
+    if (schedulerType == MLFQ) {
+        // a thread coming back from a blocking wait (I/O completion,
+        // Semaphore::V, ...) is interactive-looking, so move it up
+        if (thread->getStatus() == BLOCKED && thread->mlfqLevel > 0) {
+            thread->mlfqLevel--;
+        }
+        thread->setStatus(READY);
+        mlfqQueues[thread->mlfqLevel]->Append(thread);
+        return;
+    }
+    if (vruntimeHeap != NULL) {
+        // a new thread, or one back from a blocking wait, starts level
+        // with the others, rather than with the credit for all the
+        // time it was not runnable
+        if (thread->getStatus() != RUNNING && thread->vruntime < minVruntime) {
+            thread->vruntime = minVruntime;
+        }
+        thread->setStatus(READY);
+        thread->weight = Weight(thread);
+        cfsLoad += thread->weight;
+        vruntimeHeap->Insert(thread);
+        return;
+    }
+    if (runQueue != NULL) {
+        thread->setStatus(READY);
+        runQueue->Insert(thread, ReadyKey(thread));
+        return;
+    }
+    if (burstHeap != NULL) {
+        // the key is fixed here: a thread's remaining burst changes
+        // once it has been switched out, while it is on the heap
+        thread->readyKey = ReadyKey(thread);
+        thread->readySeq = numQueued++;
+        thread->setStatus(READY);
+        burstHeap->Insert(thread);
+        if (schedulerType == SRTF) {
+            CheckPreempt(thread);
+        }
+        return;
+    }
+
     thread->setStatus(READY);
     readyList->Append(thread);
 }
 
+//----------------------------------------------------------------------
+// Scheduler::ReadyToRunAll
+// 	Mark every thread on "threads" as ready, and put them on the
+//	ready list, in order, leaving "threads" empty.
+//
+//	Where the ready list is a single FIFO (RR, FCFS, Lottery), this
+//	is done with one splice of the whole queue onto its end, rather
+//	than an Append per thread; other policies, and real-time threads,
+//	need each thread put in its own place, through ReadyToRun.
+//
+//	"threads" is the queue of threads to make ready, for instance
+//	the waiters on a condition being broadcast.
+//----------------------------------------------------------------------
+
+void
+Scheduler::ReadyToRunAll(ThreadQueue *threads)
+{
+    Thread *thread, *next;
+    int now = kernel->stats->totalTicks;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+
+    if (readyList == NULL) {
+        while ((thread = threads->RemoveFront()) != NULL) {
+            ReadyToRun(thread);
+        }
+        return;
+    }
+    for (thread = threads->Front(); thread != NULL; thread = next) {
+        next = threads->Next(thread);
+        if (thread->rtPeriod > 0) {
+            threads->Remove(thread);
+            ReadyToRun(thread);
+            continue;
+        }
+        DEBUG(dbgThread, "Putting thread on ready list: " << thread->getName());
+        thread->readyTime = now;
+        if (thread->getStatus() == BLOCKED) {
+            thread->accounting->blockedTicks += now - thread->blockedTime;
+        }
+        thread->setStatus(READY);
+    }
+    readyList->Splice(threads);
+}
+
 //----------------------------------------------------------------------
 // Scheduler::FindNextToRun
 // 	Return the next thread to be scheduled onto the CPU.
@@ -136,8 +295,54 @@ Scheduler::FindNextToRun ()
 {
     ASSERT(kernel->interrupt->getLevel() == IntOff);
 
+    // real-time threads first, earliest deadline first; a real-time
+    // thread at the end of its time slice keeps the CPU if its
+    // deadline is still the earliest
+    Thread *current = kernel->currentThread;
+    if (current->rtPeriod > 0 && current->getStatus() == RUNNING
+            && (realTimeHeap->IsEmpty() || current->rtAbsDeadline
+                <= realTimeHeap->Front()->rtAbsDeadline)) {
+        return NULL;
+    }
+    if (!realTimeHeap->IsEmpty()) {
+        return realTimeHeap->RemoveFront();
+    }
+
+    if (schedulerType == MLFQ) {
+        for (int i = 0; i < NumMLFQLevels; i++) {
+            if (!mlfqQueues[i]->IsEmpty()) {
+                return mlfqQueues[i]->RemoveFront();
+            }
+        }
+        return NULL;
+    }
+    if (vruntimeHeap != NULL) {
+        Thread *thread;
+
+        if (vruntimeHeap->IsEmpty()) {
+            return NULL;
+        }
+        if (schedulerType == Stride && StillAhead(kernel->currentThread)) {
+            return NULL;
+        }
+        thread = vruntimeHeap->RemoveFront();
+        cfsLoad -= thread->weight;
+        if (thread->vruntime > minVruntime) {
+            minVruntime = thread->vruntime;
+        }
+        return thread;
+    }
+    if (runQueue != NULL) {
+        return runQueue->RemoveFront();
+    }
+    if (burstHeap != NULL) {
+        return burstHeap->IsEmpty() ? NULL : burstHeap->RemoveFront();
+    }
+
     if (readyList->IsEmpty()) {
 	return NULL;
+    } else if (schedulerType == Lottery) {
+        return DrawLottery();
     } else {
     	return readyList->RemoveFront();
     }
@@ -174,18 +379,29 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 	 toBeDestroyed = oldThread;
     }
     
-#ifdef USER_PROGRAM			// ignore until running user programs 
-    if (oldThread->space != NULL) {	// if this thread is a user program,
-        oldThread->SaveUserState(); 	// save the user's CPU registers
-	oldThread->space->SaveState();
-    }
-#endif
+    // a user program's CPU registers stay in the machine: they are
+    // only saved if another user program is run (ClaimUserContext)
     
     oldThread->CheckOverflow();		    // check if the old thread
 					    // had an undetected stack overflow
 
+    // charge the switch to the thread giving up the CPU: a thread
+    // still ready was preempted (unless it called Yield itself)
+    if (oldThread->getStatus() == READY && kernel->interrupt->isPreempting()) {
+        oldThread->accounting->involuntarySwitches++;
+    } else {
+        oldThread->accounting->voluntarySwitches++;
+    }
+    nextThread->accounting->readyTicks += kernel->stats->totalTicks - nextThread->readyTime;
+
     kernel->currentThread = nextThread;  // switch to the next thread
     nextThread->setStatus(RUNNING);      // nextThread is now running
+    nextThread->dispatchTime = kernel->stats->totalTicks;
+    nextThread->quantumStart = nextThread->dispatchTime;
+    nextThread->numDispatches++;
+    if (nextThread != oldThread) {
+        kernel->stats->numContextSwitches++;
+    }
     
     DEBUG(dbgThread, "Switching from: " << oldThread->getName() << " to: " << nextThread->getName());
     
@@ -208,9 +424,11 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 					// and needs to be cleaned up
     
 #ifdef USER_PROGRAM
-    if (oldThread->space != NULL) {	    // if there is an address space
-        oldThread->RestoreUserState();     // to restore, do it.
+    if (oldThread->space != NULL	    // if there is an address space
+	    && !oldThread->ClaimUserContext()) {
+        oldThread->RestoreUserState();     // that isn't loaded, restore it
 	oldThread->space->RestoreState();
+	kernel->stats->numUserRestores++;
     }
 #endif
 }
@@ -227,10 +445,452 @@ SchedulerType Scheduler::get_scheduler_type() {
     return schedulerType;
 }
 
+//----------------------------------------------------------------------
+// Scheduler::ReadyKey
+// 	Return the key "thread" is ordered by on the ready queue: its
+//	predicted burst time under SJF, what is left of it under SRTF,
+//	its effective priority under Priority (which may be better than
+//	the one it was given, while it holds a lock that a thread with
+//	a better priority is waiting for).  Smaller keys are scheduled
+//	first.
+//----------------------------------------------------------------------
 
+int
+Scheduler::ReadyKey(Thread *thread)
+{
+    if (schedulerType == SJF) {
+        return thread->predicted_burst_time_of_the_thread;
+    }
+    if (schedulerType == SRTF) {
+        return RemainingBurst(thread);
+    }
+    return thread->effectivePriority;
+}
 
+//----------------------------------------------------------------------
+// Scheduler::ChangePriority
+// 	Set the effective priority of "thread" (see Lock::UpdatePriority).
+//	If it is on the Priority ready queue, it is moved to where its
+//	new priority puts it.
+//
+//	"thread" -- the thread whose priority changes
+//	"priority" -- its new effective priority
+//----------------------------------------------------------------------
 
+void
+Scheduler::ChangePriority(Thread *thread, int priority)
+{
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
 
+    if (schedulerType == Priority && thread->getStatus() == READY
+            && thread->rtPeriod == 0) {
+        runQueue->Remove(thread, ReadyKey(thread));
+        thread->effectivePriority = priority;
+        runQueue->Insert(thread, ReadyKey(thread));
+    } else {
+        thread->effectivePriority = priority;
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::RemainingBurst
+// 	Return how much longer "thread" is predicted to run before it
+//	blocks: its predicted burst, less the CPU time it has already
+//	used in this burst.  For the running thread, that includes the
+//	time since it was dispatched.
+//----------------------------------------------------------------------
+
+int
+Scheduler::RemainingBurst(Thread *thread)
+{
+    int used = thread->burstTicks;
+
+    if (thread == kernel->currentThread && thread->getStatus() == RUNNING) {
+        used += kernel->stats->totalTicks - thread->dispatchTime;
+    }
+    if (used >= thread->predicted_burst_time_of_the_thread) {
+        return 0;
+    }
+    return thread->predicted_burst_time_of_the_thread - used;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::CheckPreempt
+// 	"thread" was just put on the ready queue.  Under SRTF, if it is
+//	predicted to finish its burst sooner than the running thread,
+//	ask for the running thread to be preempted.  The switch itself
+//	happens in Interrupt::OneTick, once it is safe.  Under Priority,
+//	likewise if its priority is better (Lock::Release uses this to
+//	hand the CPU over along with the lock).
+//
+//	Nothing to do if no thread is running (we were called while the
+//	CPU is idle), or if "thread" is the running thread yielding.
+//----------------------------------------------------------------------
+
+void
+Scheduler::CheckPreempt(Thread *thread)
+{
+    Thread *current = kernel->currentThread;
+
+    if (thread == current || current->getStatus() != RUNNING) {
+        return;
+    }
+    if (schedulerType == Priority) {
+        if (ReadyKey(thread) < ReadyKey(current)) {
+            DEBUG(dbgThread, "Thread " << thread->getName() << " preempts " << current->getName());
+            kernel->interrupt->Preempt();
+        }
+        return;
+    }
+    if (schedulerType != SRTF) {
+        return;
+    }
+    if (ReadyKey(thread) < RemainingBurst(current)) {
+        DEBUG(dbgThread, "Thread " << thread->getName() << " preempts " << current->getName());
+        kernel->interrupt->Preempt();
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::EndBurst
+// 	"thread" is giving up the CPU, in Yield or Sleep.  Under SJF and
+//	SRTF, this ends its current CPU burst, and the burst is used to
+//	update its predicted burst time -- unless the thread is being
+//	preempted under SRTF, in which case the burst is not over yet:
+//	just remember how much of it has been used.
+//
+//	Under CFS and Stride, charge the thread for the time it ran,
+//	scaled by its weight, before it goes back on the heap.
+//----------------------------------------------------------------------
+
+void
+Scheduler::EndBurst(Thread *thread)
+{
+    int ran = kernel->stats->totalTicks - thread->dispatchTime;
+
+    if (schedulerType == CFS || schedulerType == Stride) {
+        thread->vruntime += ran * CFSNice0Weight / Weight(thread);
+        return;
+    }
+    if (schedulerType != SJF && schedulerType != SRTF) {
+        return;
+    }
+    if (schedulerType == SRTF && kernel->interrupt->isPreempting()) {
+        thread->burstTicks += ran;
+        return;
+    }
+    RecordBurst(thread, thread->burstTicks + ran);
+    thread->burstTicks = 0;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::RecordBurst
+// 	"thread" just finished a CPU burst of "burst" ticks.  Fold that
+//	into its predicted burst time with an exponential average:
+//
+//		tau = alpha * burst + (1 - alpha) * tau
+//
+//	SJF then orders the ready queue by the prediction, rather than
+//	by a number set by hand.
+//----------------------------------------------------------------------
+
+void
+Scheduler::RecordBurst(Thread *thread, int burst)
+{
+    double tau = burstAlpha * burst
+            + (1.0 - burstAlpha) * thread->predicted_burst_time_of_the_thread;
+
+    thread->set_predicted_burst_time((int) (tau + 0.5));
+    DEBUG(dbgThread, "Burst of " << thread->getName() << ": " << burst << " ticks, predicting " << thread->predicted_burst_time_of_the_thread);
+}
+
+//----------------------------------------------------------------------
+// Scheduler::QuantumExpired
+// 	Return TRUE if "thread" has run for at least the time quantum
+//	of its MLFQ level, or its CFS time slice, since it was last given
+//	the CPU.  Called from the timer interrupt handler.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::QuantumExpired(Thread *thread)
+{
+    if (schedulerType == CFS) {
+        return !vruntimeHeap->IsEmpty() && (kernel->stats->totalTicks
+                - thread->dispatchTime) >= TimeSlice(thread);
+    }
+
+    int quantum = MLFQBaseQuantum << thread->mlfqLevel;
+
+    return (kernel->stats->totalTicks - thread->quantumStart) >= quantum;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Weight
+// 	Return the CFS weight of "thread", treating its priority as a
+//	nice value between -20 and 19.  Under Stride, the weight is the
+//	thread's tickets, including any lent to it.
+//----------------------------------------------------------------------
+
+int
+Scheduler::Weight(Thread *thread)
+{
+    int nice = thread->priority_of_the_thread;
+
+    if (schedulerType == Stride) {
+        return (thread->getTickets() > 0) ? thread->getTickets() : 1;
+    }
+
+    if (nice < -20) {
+        nice = -20;
+    } else if (nice > 19) {
+        nice = 19;
+    }
+    return cfsNiceToWeight[nice + 20];
+}
+
+//----------------------------------------------------------------------
+// Scheduler::TimeSlice
+// 	Return how long the running "thread" may keep the CPU under CFS:
+//	its share, by weight, of CFSLatency among all runnable threads.
+//	The more threads are runnable, the shorter the slice, down to
+//	CFSMinGranularity.
+//----------------------------------------------------------------------
+
+int
+Scheduler::TimeSlice(Thread *thread)
+{
+    int weight = Weight(thread);
+    int slice = CFSLatency * weight / (cfsLoad + weight);
+
+    return (slice < CFSMinGranularity) ? CFSMinGranularity : slice;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Demote
+// 	"thread" used up its whole quantum, so it looks CPU bound:
+//	push it down one MLFQ level, where the quantum is twice as long.
+//	The new quantum starts counting now, in case the thread is
+//	allowed to keep the CPU because nobody else is ready.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Demote(Thread *thread)
+{
+    if (thread->mlfqLevel < NumMLFQLevels - 1) {
+        thread->mlfqLevel++;
+        DEBUG(dbgThread, "Demoting thread " << thread->getName() << " to MLFQ level " << thread->mlfqLevel);
+    }
+    thread->quantumStart = kernel->stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::Age
+// 	Every MLFQAgingInterval ticks, move each thread that has been
+//	waiting on a lower MLFQ level for MLFQAgingTicks up one level,
+//	so that a steady stream of interactive threads cannot starve
+//	the batch threads forever.
+//
+//	Called from the timer interrupt handler, with interrupts off.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Age()
+{
+    int now = kernel->stats->totalTicks;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+
+    if (now - lastAging < MLFQAgingInterval) {
+        return;
+    }
+    lastAging = now;
+
+    for (int i = 1; i < NumMLFQLevels; i++) {
+        Thread *thread, *next;
+
+        // take the threads that have waited long enough out of the
+        // middle of the queue; the others stay where they are
+        for (thread = mlfqQueues[i]->Front(); thread != NULL; thread = next) {
+            int since = max(thread->readyTime, thread->agedTime);
+
+            next = mlfqQueues[i]->Next(thread);
+            if (now - since >= MLFQAgingTicks) {
+                DEBUG(dbgThread, "Aging thread " << thread->getName() << " to MLFQ level " << i - 1);
+                thread->mlfqLevel = i - 1;
+                thread->agedTime = now;
+                mlfqQueues[i]->Remove(thread);
+                mlfqQueues[i - 1]->Append(thread);
+            }
+        }
+    }
+}
+
+
+
+
+
+
+//----------------------------------------------------------------------
+// Scheduler::StillAhead
+// 	Under Stride, return TRUE if "thread" is the running thread,
+//	giving up the CPU at the end of a time slice (in Yield), and its
+//	pass -- counting the time it has run since it was dispatched --
+//	is still smaller than that of every ready thread.  It should then
+//	keep the CPU: a thread with many tickets has to be able to run
+//	several slices in a row.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::StillAhead(Thread *thread)
+{
+    int pass;
+
+    if (thread != kernel->currentThread || thread->getStatus() != RUNNING) {
+        return FALSE;
+    }
+    pass = thread->vruntime + (kernel->stats->totalTicks
+            - thread->dispatchTime) * CFSNice0Weight / Weight(thread);
+    return pass < vruntimeHeap->Front()->vruntime;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::DrawLottery
+// 	Hold a lottery among the ready threads: pick a ticket at random,
+//	and remove and return the thread holding it.  A thread's chance
+//	of winning is its tickets (including any lent to it) over the
+//	total.  Threads with no tickets only win if nobody has any.
+//
+//	If the running thread is yielding at the end of its time slice,
+//	it takes part in the draw too; if it wins, return NULL, so that
+//	it keeps the CPU.
+//----------------------------------------------------------------------
+
+Thread *
+Scheduler::DrawLottery()
+{
+    Thread *current = kernel->currentThread;
+    Thread *winner = NULL;
+    int total = 0;
+    int ticket;
+
+    for (Thread *t = readyList->Front(); t != NULL; t = readyList->Next(t)) {
+        total += t->getTickets();
+    }
+    if (current->getStatus() != RUNNING) {
+        current = NULL;			// blocked, or finishing
+    }
+    if (total <= 0) {
+        return readyList->RemoveFront();
+    }
+
+    ticket = (int) (RandomNumber() % (total + ((current != NULL) ? current->getTickets() : 0)));
+    if (ticket >= total) {
+        DEBUG(dbgThread, "Lottery won by " << current->getName() << ", who keeps the CPU");
+        return NULL;
+    }
+    for (Thread *t = readyList->Front(); t != NULL; t = readyList->Next(t)) {
+        ticket -= t->getTickets();
+        if (ticket < 0) {
+            winner = t;
+            break;
+        }
+    }
+    ASSERT(winner != NULL);
+    DEBUG(dbgThread, "Lottery won by " << winner->getName() << " out of " << total << " tickets");
+    readyList->Remove(winner);
+    return winner;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::AdmitRealTime
+// 	Make "thread" a real-time thread, releasing a job every "period"
+//	ticks, each of which needs at most "budget" ticks of CPU and is
+//	due "deadline" ticks after its release.  The first job is
+//	released now.
+//
+//	Admission control: refuse (and return FALSE) if the total
+//	utilization of the real-time threads would go over
+//	RTUtilizationBound, since then EDF could no longer promise to
+//	meet every deadline.  A refused thread stays a normal thread.
+//----------------------------------------------------------------------
+
+bool
+Scheduler::AdmitRealTime(Thread *thread, int period, int deadline, int budget)
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    double utilization = (double) budget / deadline;
+
+    ASSERT(period > 0 && deadline > 0 && deadline <= period);
+    ASSERT(budget > 0 && thread->rtPeriod == 0);
+
+    if (rtUtilization + utilization > RTUtilizationBound) {
+        DEBUG(dbgThread, "Not admitting " << thread->getName() << ": utilization would be " << rtUtilization + utilization);
+        (void) kernel->interrupt->SetLevel(oldLevel);
+        return FALSE;
+    }
+    rtUtilization += utilization;
+    thread->rtPeriod = period;
+    thread->rtDeadline = deadline;
+    thread->rtBudget = budget;
+    thread->rtRelease = kernel->stats->totalTicks;
+    thread->rtAbsDeadline = thread->rtRelease + deadline;
+    thread->rtWaiting = FALSE;
+    thread->rtMissed = FALSE;
+    realTimeThreads->Append(thread);
+    kernel->alarm->StartTicking();	// releases happen on timer ticks
+    DEBUG(dbgThread, "Admitting " << thread->getName() << " as real-time: utilization now " << rtUtilization);
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::LeaveRealTime
+// 	"thread", a real-time thread, is finishing: give back its share
+//	of the utilization.
+//----------------------------------------------------------------------
+
+void
+Scheduler::LeaveRealTime(Thread *thread)
+{
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+
+    realTimeThreads->Remove(thread);
+    rtUtilization -= (double) thread->rtBudget / thread->rtDeadline;
+    thread->rtPeriod = 0;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::CheckRealTime
+// 	Called from the timer interrupt handler.  Record a deadline miss
+//	for every real-time job that is past its deadline and not done
+//	yet (once per job), and make ready every real-time thread whose
+//	next job is due.
+//----------------------------------------------------------------------
+
+void
+Scheduler::CheckRealTime()
+{
+    int now = kernel->stats->totalTicks;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+
+    for (ListIterator<Thread *> it(realTimeThreads); !it.IsDone(); it.Next()) {
+        Thread *thread = it.Item();
+
+        if (thread->rtWaiting) {
+            if (now >= thread->rtRelease) {
+                thread->rtWaiting = FALSE;
+                thread->rtAbsDeadline = thread->rtRelease + thread->rtDeadline;
+                thread->rtMissed = FALSE;
+                ReadyToRun(thread);
+            }
+        } else if (now > thread->rtAbsDeadline && !thread->rtMissed) {
+            DEBUG(dbgThread, "Thread " << thread->getName() << " missed its deadline at " << thread->rtAbsDeadline);
+            thread->rtMissed = TRUE;
+            kernel->stats->numDeadlineMisses++;
+        }
+    }
+}
 
 //----------------------------------------------------------------------
 // Scheduler::CheckToBeDestroyed
@@ -258,5 +918,30 @@ void
 Scheduler::Print()
 {
     cout << "Ready list contents:\n";
+    if (!realTimeHeap->IsEmpty()) {
+        cout << "  real-time: ";
+        realTimeHeap->Apply(ThreadPrint);
+        cout << "\n";
+    }
+    if (schedulerType == MLFQ) {
+        for (int i = 0; i < NumMLFQLevels; i++) {
+            cout << "  level " << i << ": ";
+            mlfqQueues[i]->Apply(ThreadPrint);
+            cout << "\n";
+        }
+        return;
+    }
+    if (runQueue != NULL) {
+        runQueue->Apply(ThreadPrint);
+        return;
+    }
+    if (burstHeap != NULL) {
+        burstHeap->Apply(ThreadPrint);
+        return;
+    }
+    if (vruntimeHeap != NULL) {
+        vruntimeHeap->Apply(ThreadPrint);
+        return;
+    }
     readyList->Apply(ThreadPrint);
 }
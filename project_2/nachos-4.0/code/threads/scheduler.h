@@ -11,7 +11,11 @@
 
 #include "copyright.h"
 #include "list.h"
+#include "dlist.h"
+#include "heap.h"
+#include "runqueue.h"
 #include "thread.h"
+#include "stats.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
@@ -21,9 +25,59 @@ enum SchedulerType {
         RR,     // Round Robin
         SJF,
         Priority,
-		FCFS
+		FCFS,
+        MLFQ,   // Multilevel Feedback Queue
+        SRTF,   // Shortest Remaining Time First (preemptive SJF)
+        CFS,    // Completely Fair Scheduler
+        Lottery,
+        Stride
 };
 
+// Default weight given to the most recent CPU burst when predicting
+// the next one for SJF and SRTF:  tau = alpha * burst + (1 - alpha) * tau.
+
+const double DefaultBurstAlpha = 0.5;
+
+// Parameters for the multilevel feedback queue.  Level 0 is the most
+// favored queue; each level below it doubles the time quantum.  A thread
+// that uses up its quantum drops one level, a thread woken up from a
+// blocking wait (I/O, semaphore) rises one level, and a thread that has
+// been waiting on the ready list for MLFQAgingTicks is moved up one
+// level so that batch jobs are not starved by interactive ones.
+
+const int NumMLFQLevels = 4;
+const int MLFQBaseQuantum = TimerTicks;		// quantum of level 0
+const int MLFQAgingTicks = 20 * TimerTicks;	// wait before a boost
+const int MLFQAgingInterval = 4 * TimerTicks;	// how often to look
+
+// Parameters for the completely fair scheduler.  Each thread is charged
+// virtual runtime for the CPU time it uses, scaled down by its weight,
+// and the thread with the least virtual runtime runs next.  Every
+// runnable thread should get to run once per CFSLatency ticks, so a
+// thread's time slice is its share (by weight) of CFSLatency, but never
+// less than CFSMinGranularity.  A thread's weight comes from its
+// priority, used as a UNIX "nice" value: 0 is CFSNice0Weight, and each
+// step up or down is worth about 10% of the CPU.
+
+const int CFSLatency = 4 * TimerTicks;
+const int CFSMinGranularity = TimerTicks;
+const int CFSNice0Weight = 1024;
+
+// Lottery and stride scheduling hand out the CPU one timer interrupt at
+// a time, in proportion to each thread's tickets.  Lottery draws a
+// winning ticket at random; Stride runs the thread with the smallest
+// "pass", and advances a thread's pass by CFSNice0Weight / tickets for
+// each tick it runs -- CFS with the tickets as the weight.
+
+// Real-time threads are scheduled Earliest Deadline First, ahead of
+// the threads of whichever policy is in use.  A thread is only admitted
+// if the total utilization (budget / deadline, summed over all the
+// real-time threads) stays within RTUtilizationBound, so that EDF can
+// meet every deadline.  Jobs are released, and deadlines checked, at
+// timer interrupts, so periods should be multiples of TimerTicks.
+
+const double RTUtilizationBound = 1.0;
+
 class Scheduler {
   public:
 	Scheduler();		// Initialize list of ready threads 
@@ -32,6 +86,8 @@ class Scheduler {
 
 	void ReadyToRun(Thread* thread);	
     					// Thread can be dispatched.
+	void ReadyToRunAll(ThreadQueue *threads);
+					// All of them can; empties threads
 	Thread* FindNextToRun();	// Dequeue first thread on the ready 
 					// list, if any, and return thread.
 	void Run(Thread* nextThread, bool finishing);
@@ -44,12 +100,79 @@ class Scheduler {
 
 	SchedulerType get_scheduler_type(); //This function is to get scheduler types.
 
+	int ReadyKey(Thread *thread);	// What the ready queue orders thread by
+	void ChangePriority(Thread *thread, int priority);
+					// Set thread's effective priority,
+					// moving it on the ready queue
+	void CheckPreempt(Thread *thread);
+					// Should thread take the CPU away
+					// from the running thread (SRTF,
+					// or Priority)?
+	void SetBurstAlpha(double alpha) { burstAlpha = alpha; }
+					// Weight of the newest burst in
+					// the SJF burst prediction
+	double GetBurstAlpha() { return burstAlpha; }
+	void EndBurst(Thread *thread);	// thread is giving up the CPU
+	int RemainingBurst(Thread *thread);
+					// Predicted CPU time thread still
+					// needs in its current burst
+
+	bool QuantumExpired(Thread *thread);
+				// Has thread used up its MLFQ quantum,
+				// or its CFS time slice?
+	void Demote(Thread *thread);	// Move thread down one MLFQ level
+	void Age();			// Boost threads starving on the
+					// lower MLFQ levels
+
+	bool AdmitRealTime(Thread *thread, int period, int deadline,
+			   int budget);	// Make thread a real-time thread,
+					// if there is room
+	void LeaveRealTime(Thread *thread);
+					// thread is finishing
+	void CheckRealTime();		// Release due jobs, and record
+					// missed deadlines
+	bool AnyRealTime() { return !realTimeThreads->IsEmpty(); }
+					// any real-time threads admitted?
+
+	int Weight(Thread *thread);	// CFS weight (Stride: tickets)
+					// of thread
+	int TimeSlice(Thread *thread);	// CFS time slice of running thread
+
     // SelfTest for scheduler is implemented in class Thread
 
   private:
 	SchedulerType schedulerType;
-	List<Thread *> *readyList;	// queue of threads that are ready to run,
+	ThreadQueue *readyList;		// queue of threads that are ready to run,
 					// but not running
+	RunQueue *runQueue;		// constant time ready queue, used
+					// instead of readyList by Priority
+	Heap<Thread *> *burstHeap;	// ready threads ordered by predicted
+					// (SJF) or remaining (SRTF) burst,
+					// used instead of readyList
+	int numQueued;			// threads put on burstHeap so far
+	ThreadQueue *mlfqQueues[NumMLFQLevels];
+					// ready queues for MLFQ, one per level
+	int lastAging;			// when Age() last did a pass
+	Heap<Thread *> *vruntimeHeap;	// ready threads ordered by vruntime,
+					// used instead of readyList by CFS
+					// and Stride
+	int minVruntime;		// smallest vruntime of any runnable
+					// thread; never goes backwards
+	int cfsLoad;			// total weight of threads on vruntimeHeap
+	Heap<Thread *> *realTimeHeap;	// ready real-time threads, ordered
+					// by absolute deadline
+	List<Thread *> *realTimeThreads;// all admitted real-time threads
+	double rtUtilization;		// their total utilization
+	double burstAlpha;		// weight of the last measured burst
+					// in predicted_burst_time_of_the_thread
+
+	void RecordBurst(Thread *thread, int burst);
+					// Fold thread's last CPU burst into
+					// its predicted burst time
+	Thread *DrawLottery();		// Pick a ready thread at random,
+					// weighted by tickets
+	bool StillAhead(Thread *thread);// Should the running thread keep
+					// the CPU under Stride?
 	Thread *toBeDestroyed;		// finishing thread to be destroyed
     					// by the next thread that runs
 };
@@ -16,17 +16,16 @@
 // re-set the interrupt state back to its original value (whether
 // that be disabled or enabled).
 //
-// Once we'e implemented one set of higher level atomic operations,
-// we can implement others using that implementation.  We illustrate
-// this by implementing locks and condition variables on top of 
-// semaphores, instead of directly enabling and disabling interrupts.
+// Locks and condition variables also disable interrupts directly,
+// rather than being built on semaphores: a lock needs to choose which
+// waiter gets it next (see Lock::Release), and neither needs a
+// semaphore allocated per waiter.
 //
-// Locks are implemented using a semaphore to keep track of
-// whether the lock is held or not -- a semaphore value of 0 means
-// the lock is busy; a semaphore value of 1 means the lock is free.
+// Condition variables keep their own queue of waiting threads, as
+// explained below under Condition::Wait.
 //
-// The implementation of condition variables using semaphores is
-// a bit trickier, as explained below under Condition::Wait.
+// The wait queues are ThreadQueues, linked through the threads on
+// them, so going to sleep on one never allocates memory.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -48,7 +47,7 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List<Thread *>;
+    queue = new ThreadQueue;
 }
 
 //----------------------------------------------------------------------
@@ -163,8 +162,10 @@ Semaphore::SelfTest()
 Lock::Lock(char* debugName)
 {
     name = debugName;
-    semaphore = new Semaphore("lock", 1);  // initially, unlocked
-    lockHolder = NULL;
+    waiters = new ThreadQueue;
+    lockHolder = NULL;		// initially, unlocked
+    waitingTickets = 0;
+    nextHeld = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -173,7 +174,8 @@ Lock::Lock(char* debugName)
 //----------------------------------------------------------------------
 Lock::~Lock()
 {
-    delete semaphore;
+    ASSERT(waiters->IsEmpty());
+    delete waiters;
 }
 
 char*
@@ -181,25 +183,104 @@ Lock::getName()
 {
 	return name;
 }
+//----------------------------------------------------------------------
+// Lock::BestWaiter
+//	Return the thread waiting in Acquire with the best (smallest)
+//	effective priority, the one that has waited longest if there is
+//	a tie, or NULL if nobody is waiting.
+//----------------------------------------------------------------------
+
+Thread *
+Lock::BestWaiter()
+{
+    Thread *best = NULL;
+
+    for (Thread *t = waiters->Front(); t != NULL; t = waiters->Next(t)) {
+        if (best == NULL || t->effectivePriority < best->effectivePriority) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+//----------------------------------------------------------------------
+// Lock::UpdatePriority
+//	Work out the effective priority of "thread" again: the better of
+//	its own priority and that of the best waiter on each lock it
+//	holds.  If that changed, and "thread" is itself waiting for a
+//	lock, the holder of that lock may need to change too, and so on
+//	down the chain.  Called with interrupts disabled, whenever a
+//	thread starts or stops waiting for a lock "thread" holds.
+//----------------------------------------------------------------------
+
+void
+Lock::UpdatePriority(Thread *thread)
+{
+    while (thread != NULL) {
+        int priority = thread->priority_of_the_thread;
+
+        for (Lock *held = thread->locksHeld; held != NULL;
+                held = held->nextHeld) {
+            Thread *waiter = held->BestWaiter();
+
+            if (waiter != NULL && waiter->effectivePriority < priority) {
+                priority = waiter->effectivePriority;
+            }
+        }
+        if (priority == thread->effectivePriority) {
+            return;		// nothing further down the chain changes
+        }
+        DEBUG(dbgThread, "Thread " << thread->getName() << " now runs at priority " << priority);
+        kernel->scheduler->ChangePriority(thread, priority);
+        thread = (thread->waitingFor != NULL)
+                    ? thread->waitingFor->lockHolder : NULL;
+    }
+}
+
 //----------------------------------------------------------------------
 // Lock::Acquire
 //	Atomically wait until the lock is free, then set it to busy.
-//	Equivalent to Semaphore::P(), with the semaphore value of 0
-//	equal to busy, and semaphore value of 1 equal to free.
+//
+//	While we wait, our lottery/stride tickets are lent to the
+//	lock holder, so that a thread with few tickets can't keep a
+//	thread with many waiting for long.  Once we get the lock, the
+//	tickets of anyone still waiting are lent to us instead.  Our
+//	priority is lent in the same way (see UpdatePriority).
 //----------------------------------------------------------------------
 
 void Lock::Acquire()
 {
-    semaphore->P();
-    lockHolder = kernel->currentThread;
+    Thread *thread = kernel->currentThread;
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    int lent = 0;
+
+    if (lockHolder != NULL) {
+        lent = thread->getTickets();
+        waitingTickets += lent;
+        lockHolder->donatedTickets += lent;
+    }
+    while (lockHolder != NULL) {	// lock not available
+        thread->waitingFor = this;
+        waiters->Append(thread);
+        UpdatePriority(lockHolder);	// lend it our priority
+        thread->Sleep(FALSE);		// Release takes us off waiters
+    }
+    waitingTickets -= lent;
+    lockHolder = thread;
+    nextHeld = thread->locksHeld;
+    thread->locksHeld = this;
+    thread->donatedTickets += waitingTickets;
+    UpdatePriority(thread);		// anyone still waiting lends us
+					// their priority
+    (void) kernel->interrupt->SetLevel(oldLevel);
 }
 
 //----------------------------------------------------------------------
 // Lock::Release
-//	Atomically set lock to be free, waking up a thread waiting
-//	for the lock, if any.
-//	Equivalent to Semaphore::V(), with the semaphore value of 0
-//	equal to busy, and semaphore value of 1 equal to free.
+//	Atomically set lock to be free, waking up the waiter with the
+//	best priority, if any.  We give back any priority that was lent
+//	to us for this lock; if that leaves the waiter better than us,
+//	it gets the CPU too.
 //
 //	By convention, only the thread that acquired the lock
 // 	may release it.
@@ -207,9 +288,30 @@ void Lock::Acquire()
 
 void Lock::Release()
 {
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Thread *holder = lockHolder;
+    Thread *waiter;
+    Lock **held;
+
     ASSERT(IsHeldByCurrentThread());
+    holder->donatedTickets -= waitingTickets;	// give back the loan
+    for (held = &holder->locksHeld; *held != this; held = &(*held)->nextHeld) {
+        ASSERT(*held != NULL);
+    }
+    *held = nextHeld;
+    nextHeld = NULL;
     lockHolder = NULL;
-    semaphore->V();
+    waiter = BestWaiter();
+    if (waiter != NULL) {
+        waiters->Remove(waiter);
+        waiter->waitingFor = NULL;
+        kernel->scheduler->ReadyToRun(waiter);
+    }
+    UpdatePriority(holder);			// give back the priority
+    if (waiter != NULL) {
+        kernel->scheduler->CheckPreempt(waiter);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
 }
 
 bool
@@ -228,7 +330,7 @@ Lock::IsHeldByCurrentThread()
 Condition::Condition(char* debugName)
 {
     name = debugName;
-    waitQueue = new List<Semaphore *>;
+    waitQueue = new ThreadQueue;
 }
 
 //----------------------------------------------------------------------
@@ -249,11 +351,10 @@ Condition::getName()
 //----------------------------------------------------------------------
 // Condition::Wait
 // 	Atomically release monitor lock and go to sleep.
-//	Our implementation uses semaphores to implement this, by
-//	allocating a semaphore for each waiting thread.  The signaller
-//	will V() this semaphore, so there is no chance the waiter
-//	will miss the signal, even though the lock is released before
-//	calling P().
+//	We put ourselves on waitQueue and release the lock with
+//	interrupts disabled, and keep them disabled until we are
+//	asleep, so there is no chance we miss the signal, even though
+//	the lock is released before we go to sleep.
 //
 //	Note: we assume Mesa-style semantics, which means that the
 //	waiter must re-acquire the monitor lock when waking up.
@@ -263,16 +364,17 @@ Condition::getName()
 
 void Condition::Wait(Lock* conditionLock) 
 {
-     Semaphore *waiter;
+     Thread *thread = kernel->currentThread;
+     IntStatus oldLevel;
     
      ASSERT(conditionLock->IsHeldByCurrentThread());
 
-     waiter = new Semaphore("condition", 0);
-     waitQueue->Append(waiter);
+     oldLevel = kernel->interrupt->SetLevel(IntOff);
+     waitQueue->Append(thread);
      conditionLock->Release();
-     waiter->P();
+     thread->Sleep(FALSE);		// Signal takes us off waitQueue
+     (void) kernel->interrupt->SetLevel(oldLevel);
      conditionLock->Acquire();
-     delete waiter;
 }
 
 //----------------------------------------------------------------------
@@ -284,34 +386,234 @@ void Condition::Wait(Lock* conditionLock)
 //	being woken up (unlike Hoare-style).
 //
 //	Also note: we assume the caller holds the monitor lock
-//	(unlike what is described in Birrell's paper).  This allows
-//	us to access waitQueue without disabling interrupts.
+//	(unlike what is described in Birrell's paper).  We still
+//	disable interrupts, since Scheduler::ReadyToRun needs them
+//	disabled.
 //
 //	"conditionLock" -- lock protecting the use of this condition
 //----------------------------------------------------------------------
 
 void Condition::Signal(Lock* conditionLock)
 {
-    Semaphore *waiter;
+    IntStatus oldLevel;
     
     ASSERT(conditionLock->IsHeldByCurrentThread());
     
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
     if (!waitQueue->IsEmpty()) {
-        waiter = waitQueue->RemoveFront();
-	waiter->V();
+	kernel->scheduler->ReadyToRun(waitQueue->RemoveFront());
     }
+    (void) kernel->interrupt->SetLevel(oldLevel);
 }
 
 //----------------------------------------------------------------------
 // Condition::Broadcast
-// 	Wake up all threads waiting on this condition, if any.
+// 	Wake up all threads waiting on this condition, if any.  They
+//	are handed to the scheduler as one queue, rather than one at a
+//	time.
 //
 //	"conditionLock" -- lock protecting the use of this condition
 //----------------------------------------------------------------------
 
 void Condition::Broadcast(Lock* conditionLock) 
 {
-    while (!waitQueue->IsEmpty()) {
-        Signal(conditionLock);
+    IntStatus oldLevel;
+
+    ASSERT(conditionLock->IsHeldByCurrentThread());
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    kernel->scheduler->ReadyToRunAll(waitQueue);
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// ReaderWriterLock::ReaderWriterLock
+// 	Initialize a reader-writer lock, so that it can be used for
+//	synchronization.  Initially, nobody holds it.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+ReaderWriterLock::ReaderWriterLock(char* debugName)
+{
+    name = debugName;
+    numReaders = 0;
+    writer = NULL;
+    readQueue = new ThreadQueue;
+    writeQueue = new ThreadQueue;
+}
+
+//----------------------------------------------------------------------
+// ReaderWriterLock::~ReaderWriterLock
+// 	Deallocate a reader-writer lock.  Nobody may hold it, or be
+//	waiting for it.
+//----------------------------------------------------------------------
+
+ReaderWriterLock::~ReaderWriterLock()
+{
+    ASSERT(numReaders == 0 && writer == NULL);
+    delete readQueue;
+    delete writeQueue;
+}
+
+//----------------------------------------------------------------------
+// ReaderWriterLock::AcquireRead
+//	Share the lock with any other readers.  Wait if a writer holds
+//	it, or is waiting for it (writers have preference).  Whoever
+//	wakes us up has already counted us in numReaders.
+//----------------------------------------------------------------------
+
+void
+ReaderWriterLock::AcquireRead()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Thread *thread = kernel->currentThread;
+
+    if (writer != NULL || !writeQueue->IsEmpty()) {
+	readQueue->Append(thread);
+	thread->Sleep(FALSE);		// ReleaseWrite lets us in
+    } else {
+	numReaders++;
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// ReaderWriterLock::ReleaseRead
+//	Stop sharing the lock.  If we were the last reader, and a writer
+//	is waiting, hand it the lock.
+//----------------------------------------------------------------------
+
+void
+ReaderWriterLock::ReleaseRead()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    ASSERT(numReaders > 0);
+    numReaders--;
+    if (numReaders == 0 && !writeQueue->IsEmpty()) {
+	writer = writeQueue->RemoveFront();
+	kernel->scheduler->ReadyToRun(writer);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// ReaderWriterLock::AcquireWrite
+//	Wait until nobody else holds the lock, then hold it.  Whoever
+//	wakes us up has already made us the writer.
+//----------------------------------------------------------------------
+
+void
+ReaderWriterLock::AcquireWrite()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Thread *thread = kernel->currentThread;
+
+    if (writer != NULL || numReaders > 0) {
+	writeQueue->Append(thread);
+	thread->Sleep(FALSE);		// a Release hands us the lock
+	ASSERT(writer == thread);
+    } else {
+	writer = thread;
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// ReaderWriterLock::ReleaseWrite
+//	Give up the lock.  The readers that queued up while we held it
+//	all get it together, in one batch; if there are none, the next
+//	writer gets it.
+//----------------------------------------------------------------------
+
+void
+ReaderWriterLock::ReleaseWrite()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    ASSERT(IsWriteHeldByCurrentThread());
+    writer = NULL;
+    if (!readQueue->IsEmpty()) {
+	numReaders = readQueue->NumInList();
+	kernel->scheduler->ReadyToRunAll(readQueue);
+    } else if (!writeQueue->IsEmpty()) {
+	writer = writeQueue->RemoveFront();
+	kernel->scheduler->ReadyToRun(writer);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+bool
+ReaderWriterLock::IsWriteHeldByCurrentThread()
+{
+    return writer == kernel->currentThread;
+}
+
+//----------------------------------------------------------------------
+// ReaderWriterLock::SelfTest, RWReaderHelper, RWWriterHelper
+// 	Test the reader-writer lock.  While we hold it for reading,
+//	writer W1 queues up for it, then readers R1 and R2 (behind W1,
+//	since writers have preference), then writer W2.  When we let
+//	go, the lock should go to W1, then to R1 and R2 together, and
+//	only then to W2.
+//----------------------------------------------------------------------
+
+static ReaderWriterLock *rwLock;
+static Semaphore *rwDone;
+static char rwOrder[4];		// who got the lock, in order
+static int rwSteps;
+
+static void
+RWReaderHelper(int unused)
+{
+    rwLock->AcquireRead();
+    rwOrder[rwSteps++] = 'R';
+    kernel->currentThread->Yield();	// let the other reader in too
+    rwLock->ReleaseRead();
+    rwDone->V();
+}
+
+static void
+RWWriterHelper(int unused)
+{
+    rwLock->AcquireWrite();
+    rwOrder[rwSteps++] = 'W';
+    kernel->currentThread->Yield();	// nobody else may get in
+    rwLock->ReleaseWrite();
+    rwDone->V();
+}
+
+void
+ReaderWriterLock::SelfTest()
+{
+    char *names[4] = { "rw W1", "rw R1", "rw R2", "rw W2" };
+    VoidFunctionPtr helpers[4] = { (VoidFunctionPtr) RWWriterHelper,
+	(VoidFunctionPtr) RWReaderHelper, (VoidFunctionPtr) RWReaderHelper,
+	(VoidFunctionPtr) RWWriterHelper };
+    int queued[4] = { 1, 1, 2, 2 };	// queue lengths once each is waiting
+
+    rwLock = this;
+    rwDone = new Semaphore("rw done", 0);
+    rwSteps = 0;
+    AcquireRead();
+    for (int i = 0; i < 4; i++) {
+	ThreadQueue *queue = (helpers[i] == (VoidFunctionPtr) RWReaderHelper)
+				? readQueue : writeQueue;
+	Thread *helper = new Thread(names[i]);
+
+	helper->Fork(helpers[i], (void *) 0);
+	while (queue->NumInList() < queued[i]) {	// wait until it waits
+	    kernel->currentThread->Yield();
+	}
+    }
+    ASSERT(rwSteps == 0);
+    ReleaseRead();
+    for (int i = 0; i < 4; i++) {
+	rwDone->P();
     }
+    ASSERT(rwSteps == 4);
+    ASSERT(rwOrder[0] == 'W' && rwOrder[1] == 'R' && rwOrder[2] == 'R'
+	   && rwOrder[3] == 'W');
+    delete rwDone;
 }
@@ -50,7 +50,7 @@ class Semaphore {
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List<Thread *> *queue;     
+    ThreadQueue *queue;     
 		  	// threads waiting in P() for the value to be > 0
    };
 
@@ -65,6 +65,11 @@ class Semaphore {
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).  
+//
+// To avoid priority inversion, a thread waiting for a lock lends its
+// priority to the lock holder (and to whoever that thread is waiting
+// for, and so on), and Release hands the lock to the waiter with the
+// best priority.
 
 class Lock {
   public:
@@ -84,7 +89,18 @@ class Lock {
   private:
     char *name;			// debugging assist
     Thread *lockHolder;		// thread currently holding lock
-    Semaphore *semaphore;	// we use a semaphore to implement lock
+    ThreadQueue *waiters;	// threads waiting in Acquire
+    int waitingTickets;		// tickets of the threads waiting in
+				// Acquire, lent to lockHolder
+    Lock *nextHeld;		// next lock lockHolder holds (a thread
+				// holds few locks, so no memory is
+				// allocated to keep track of them)
+
+    Thread *BestWaiter();	// waiter with the best priority
+    static void UpdatePriority(Thread *thread);
+				// work out thread's effective priority
+				// again, and pass it on down the chain
+				// of lock holders
 };
 
 // The following class defines a "condition variable".  A condition
@@ -138,6 +154,52 @@ class Condition {
 
   private:
     char* name;
-    List<Semaphore *> *waitQueue;	// list of waiting threads
+    ThreadQueue *waitQueue;		// list of waiting threads
+};
+
+// The following class defines a "reader-writer lock".  Any number of
+// readers may hold it at once, or else a single writer:
+//
+//	AcquireRead -- wait until there is no writer, then share the lock
+//
+//	ReleaseRead -- stop sharing it; the last reader out lets in a
+//		waiting writer
+//
+//	AcquireWrite -- wait until nobody holds the lock, then hold it
+//
+//	ReleaseWrite -- let in the waiting readers, or else a writer
+//
+// It suits data that is read far more often than it is written, such
+// as the file system's directory.  Writers have preference: once a
+// writer is waiting, new readers queue up behind it, so a stream of
+// readers cannot keep the writer out forever.  Readers are let in in
+// batches: when a writer is done, every reader that queued up while
+// it held the lock gets in at once, ahead of the next writer, so the
+// writers cannot starve the readers either.
+//
+// The lock is handed over directly: a thread woken up in Acquire
+// already holds the lock, so nobody can barge in ahead of it.
+
+class ReaderWriterLock {
+  public:
+    ReaderWriterLock(char* debugName);	// initialize lock to be FREE
+    ~ReaderWriterLock();		// deallocate lock
+    char* getName() { return name; }	// debugging assist
+
+    void AcquireRead();			// these are all *atomic*
+    void ReleaseRead();
+    void AcquireWrite();
+    void ReleaseWrite();
+
+    bool IsWriteHeldByCurrentThread();	// return true if the current
+					// thread holds the lock to write
+    void SelfTest();			// test routine for the lock
+
+  private:
+    char *name;				// debugging assist
+    int numReaders;			// readers holding the lock
+    Thread *writer;			// writer holding it, if any
+    ThreadQueue *readQueue;		// readers waiting in AcquireRead
+    ThreadQueue *writeQueue;		// writers waiting in AcquireWrite
 };
 #endif // SYNCH_H
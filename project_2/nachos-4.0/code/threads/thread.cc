@@ -27,6 +27,46 @@ using namespace std;
 // this is put at the top of the execution stack, for detecting stack overflows
 const int STACK_FENCEPOST = 0xdedbeef;
 
+// Stacks of threads that have been deleted, ready to be reused.  Each
+// still has its unmapped guard pages around it, so reusing one saves
+// the host the allocation and the two mprotect calls on each side.
+static int *stackPool[StackPoolSize];
+static int numPooledStacks = 0;
+
+// Threads themselves come from a slab cache, a few to a slab.
+SlabCache Thread::cache("Thread", sizeof(Thread), 8);
+
+//----------------------------------------------------------------------
+// NewStack
+// 	Return a stack of StackSize words, with guard pages around it:
+//	one from the pool if there is one, otherwise a new one.
+//----------------------------------------------------------------------
+
+static int *
+NewStack()
+{
+    if (numPooledStacks > 0) {
+	return stackPool[--numPooledStacks];
+    }
+    return (int *) AllocBoundedArray(StackSize * sizeof(int));
+}
+
+//----------------------------------------------------------------------
+// RecycleStack
+// 	Put the stack of a deleted thread in the pool, or if the pool is
+//	full, give it back to the host.
+//----------------------------------------------------------------------
+
+static void
+RecycleStack(int *stack)
+{
+    if (numPooledStacks < StackPoolSize) {
+	stackPool[numPooledStacks++] = stack;
+    } else {
+	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+    }
+}
+
 //----------------------------------------------------------------------
 // Thread::Thread
 // 	Initialize a thread control block, so that we can then call
@@ -41,6 +81,32 @@ Thread::Thread(char* threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+    start_time_of_the_thread = 0;
+    priority_of_the_thread = 0;
+    predicted_burst_time_of_the_thread = 0;
+    mlfqLevel = 0;
+    readyTime = 0;
+    dispatchTime = 0;
+    numDispatches = 0;
+    agedTime = 0;
+    blockedTime = 0;
+    accounting = kernel->stats->AddThread(threadName);
+    quantumStart = 0;
+    burstTicks = 0;
+    readyKey = 0;
+    readySeq = 0;
+    wakeTime = 0;
+    sleepNext = NULL;
+    vruntime = 0;
+    weight = 0;
+    tickets = DefaultTickets;
+    donatedTickets = 0;
+    effectivePriority = 0;
+    waitingFor = NULL;
+    locksHeld = NULL;
+    rtPeriod = rtDeadline = rtBudget = 0;
+    rtRelease = rtAbsDeadline = 0;
+    rtWaiting = rtMissed = FALSE;
     for (int i = 0; i < MachineStateSize; i++) {
 	machineState[i] = NULL;		// not strictly necessary, since
 					// new thread ignores contents 
@@ -68,8 +134,18 @@ Thread::~Thread()
     DEBUG(dbgThread, "Deleting thread: " << name);
 
     ASSERT(this != kernel->currentThread);
-    if (stack != NULL)
-	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+    ASSERT(locksHeld == NULL);		// don't finish holding a lock
+    ASSERT(!queueLink.IsLinked());	// nor while still on a queue
+    kernel->stats->RetireThread(accounting);
+#ifdef USER_PROGRAM
+    if (kernel->machine != NULL && kernel->machine->userContext == this) {
+	kernel->machine->userContext = NULL;	// nothing to save
+    }
+#endif
+    if (stack != NULL) {
+	CheckOverflow();	// don't hand a trashed stack on
+	RecycleStack(stack);
+    }
 }
 
 //----------------------------------------------------------------------
@@ -180,6 +256,9 @@ Thread::Finish ()
     
     DEBUG(dbgThread, "Finishing thread: " << name);
     
+    if (rtPeriod > 0) {
+	kernel->scheduler->LeaveRealTime(this);
+    }
     Sleep(TRUE);				// invokes SWITCH
     // not reached
 }
@@ -214,6 +293,10 @@ Thread::Yield ()
     
     nextThread = kernel->scheduler->FindNextToRun();
     if (nextThread != NULL) {
+	if (kernel->interrupt->isPreempting()) {
+	    kernel->stats->numPreemptions++;
+	}
+	kernel->scheduler->EndBurst(this);
 	kernel->scheduler->ReadyToRun(this);
 	kernel->scheduler->Run(nextThread, FALSE);
     }
@@ -244,6 +327,7 @@ void
 Thread::Sleep (bool finishing)
 {
     Thread *nextThread;
+    bool idled = FALSE;
     
     ASSERT(this == kernel->currentThread);
     ASSERT(kernel->interrupt->getLevel() == IntOff);
@@ -251,8 +335,17 @@ Thread::Sleep (bool finishing)
     DEBUG(dbgThread, "Sleeping thread: " << name);
 
     status = BLOCKED;
-    while ((nextThread = kernel->scheduler->FindNextToRun()) == NULL)
+    blockedTime = kernel->stats->totalTicks;
+    if (!finishing) {
+	kernel->scheduler->EndBurst(this);
+    }
+    while ((nextThread = kernel->scheduler->FindNextToRun()) == NULL) {
 	kernel->interrupt->Idle();	// no one to run, wait for an interrupt
+	idled = TRUE;
+    }
+    if (idled) {
+	kernel->alarm->StartTicking();	// the timer may have stopped
+    }
     
     // returns when it's time for us to run
     kernel->scheduler->Run(nextThread, finishing); 
@@ -302,6 +395,9 @@ PLabelToAddr(void *plabel)
 //		calls (*func)(arg)
 //		calls Thread::Finish
 //
+//	The stack may be one left over from a deleted thread; the
+//	fencepost is written again either way.
+//
 //	"func" is the procedure to be forked
 //	"arg" is the parameter to be passed to the procedure
 //----------------------------------------------------------------------
@@ -309,7 +405,7 @@ PLabelToAddr(void *plabel)
 void
 Thread::StackAllocate (VoidFunctionPtr func, void *arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = NewStack();
 
 #ifdef PARISC
     // HP stack works from low addresses to high addresses
@@ -400,6 +496,44 @@ Thread::RestoreUserState()
 	kernel->machine->WriteRegister(i, userRegisters[i]);
 }
 
+//----------------------------------------------------------------------
+// Thread::ClaimUserContext
+//	Make this thread the one whose user state is in the machine.
+//
+//	The user registers and page table are not saved when a user
+//	thread gives up the CPU: they stay in the machine, and are only
+//	saved here, when some other user thread needs it.  So a switch
+//	to a kernel thread and back (or to nobody, while waiting for
+//	I/O) costs no save and restore at all.
+//
+// Returns:
+//	TRUE if the machine already held our state; otherwise the caller
+//	must load it (RestoreUserState, or by starting the program).
+//----------------------------------------------------------------------
+
+bool
+Thread::ClaimUserContext()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    Thread *owner = kernel->machine->userContext;
+
+    ASSERT(space != NULL);
+    if (owner == this) {
+	kernel->stats->numUserReloadsSaved++;
+	(void) kernel->interrupt->SetLevel(oldLevel);
+	return TRUE;
+    }
+    if (owner != NULL) {
+	owner->SaveUserState();
+	owner->space->SaveState();
+	kernel->stats->numUserSaves++;
+    }
+    kernel->machine->BreakLink();	// owner's LL, if any, is void
+    kernel->machine->userContext = this;
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    return FALSE;
+}
+
 #endif
 
 //----------------------------------------------------------------------
@@ -446,7 +580,9 @@ void Thread::set_start_time(int start_time_) {
 }
 
 void Thread::set_priority(int priority_) {
+    ASSERT(priority_ >= MinPriority && priority_ <= MaxPriority);
     priority_of_the_thread = priority_;
+    effectivePriority = priority_;
 }
 
 void Thread::set_predicted_burst_time(int predicted_burst_time_) {
@@ -525,4 +661,314 @@ void Thread::testing_function_2() {
         (*threa_).Fork((VoidFunctionPtr)test_scheduling_by_decreasing_predicted_burst_time, (void *)NULL);
     }
     (*((*kernel).currentThread)).Yield();
-}
\ No newline at end of file
+}
+//Signalled by each job of testing_function_3() when it is done.
+static Semaphore * jobs_done = NULL;
+
+//My self-defined testing-related function: void test_long_job(int units)
+//Each unit of work is one OneTick() (SystemTick ticks of CPU time).
+void test_long_job(int units) {
+    Thread * thre = (*kernel).currentThread;
+    for (int j = units; j > 0; j--) {
+        (*((*kernel).interrupt)).OneTick();
+        cout << "There remains " << j-1 << " unit for " << (*thre).getName() << " to do." << endl;
+    }
+    cout << (*thre).getName() << " has finished all the work at tick " << (*((*kernel).stats)).totalTicks << "." << endl;
+    cout << " " << endl;
+    (*jobs_done).V();
+}
+
+//My self-defined testing-related function: void test_short_job_arriving_later(int units)
+//Sleep until the next timer interrupt first, so the job becomes ready
+//while the long job is running.
+void test_short_job_arriving_later(int units) {
+    (*((*kernel).alarm)).WaitUntil(1);
+    cout << (*((*kernel).currentThread)).getName() << " is ready again at tick " << (*((*kernel).stats)).totalTicks << "." << endl;
+    test_long_job(units);
+}
+
+//My self-defined testing-related function: void testing_function_3()
+//There are 2 threads in testing_function_3(): under SRTF, C2 should
+//preempt C1 as soon as it wakes up; under SJF, it waits for C1.
+//The main thread waits for both, so that they have the CPU to themselves.
+void Thread::testing_function_3() {
+    jobs_done = new Semaphore("jobs done", 0);
+
+    Thread * long_job = new Thread("C1");
+    (*long_job).set_predicted_burst_time(40 * SystemTick);
+    (*long_job).Fork((VoidFunctionPtr)test_long_job, (void *)40);
+
+    Thread * short_job = new Thread("C2");
+    (*short_job).set_predicted_burst_time(3 * SystemTick);
+    (*short_job).Fork((VoidFunctionPtr)test_short_job_arriving_later, (void *)3);
+
+    (*jobs_done).P();
+    (*jobs_done).P();
+    delete jobs_done;
+    jobs_done = NULL;
+}
+
+//Bookkeeping for testing_function_4(): each job counts the CPU ticks it
+//actually gets, until simulated time reaches share_test_end.
+static const int number_of_share_jobs = 3;
+static int share_ticks[number_of_share_jobs];
+static int share_test_end = 0;
+
+//My self-defined testing-related function: void test_share_job(int which)
+void test_share_job(int which) {
+    while ((*((*kernel).stats)).totalTicks < share_test_end) {
+        (*((*kernel).interrupt)).OneTick();
+        share_ticks[which] += SystemTick;
+    }
+    (*jobs_done).V();
+}
+
+//Lock shared by the two threads of the ticket transfer check.
+static Lock * share_lock = NULL;
+
+//My self-defined testing-related function: void test_lock_waiter(int unused)
+//Block on share_lock, so that our tickets are lent to its holder.
+void test_lock_waiter(int unused) {
+    (*share_lock).Acquire();
+    cout << (*((*kernel).currentThread)).getName() << " got the lock, and holds " << (*((*kernel).currentThread)).getTickets() << " tickets." << endl;
+    (*share_lock).Release();
+    (*jobs_done).V();
+}
+
+//My self-defined testing-related function: void testing_function_4()
+//Verification harness for lottery and stride scheduling: D1, D2, D3 hold
+//100, 200 and 300 tickets and compete for the CPU for 300 timer periods;
+//compare the share of the CPU each one got with the share it was given.
+//Then check that a thread blocked on a Lock lends its tickets to the holder.
+void Thread::testing_function_4() {
+    char * array_of_names[number_of_share_jobs] = {"D1", "D2", "D3"};
+    int array_of_tickets[number_of_share_jobs] = {100, 200, 300};
+    int total_tickets = 0;
+    int total_ticks = 0;
+
+    jobs_done = new Semaphore("jobs done", 0);
+    share_test_end = (*((*kernel).stats)).totalTicks + 300 * TimerTicks;
+    for (int j = 0; j < number_of_share_jobs; j++) {
+        Thread * job = new Thread(array_of_names[j]);
+        (*job).tickets = array_of_tickets[j];
+        share_ticks[j] = 0;
+        total_tickets += array_of_tickets[j];
+        (*job).Fork((VoidFunctionPtr)test_share_job, (void *)j);
+    }
+    for (int j = 0; j < number_of_share_jobs; j++) {
+        (*jobs_done).P();
+    }
+    for (int j = 0; j < number_of_share_jobs; j++) {
+        total_ticks += share_ticks[j];
+    }
+
+    cout << "thread\ttickets\tconfigured\tachieved\tticks" << endl;
+    for (int j = 0; j < number_of_share_jobs; j++) {
+        double configured = 100.0 * array_of_tickets[j] / total_tickets;
+        double achieved = (total_ticks > 0) ? 100.0 * share_ticks[j] / total_ticks : 0.0;
+        cout << array_of_names[j] << "\t" << array_of_tickets[j] << "\t" << configured << "%\t\t" << achieved << "%\t\t" << share_ticks[j] << endl;
+    }
+
+    //Ticket transfer: main holds the lock with 10 tickets; E1 (500 tickets)
+    //waits for it, so main should hold 510 until it releases the lock.
+    share_lock = new Lock("share lock");
+    int main_tickets = (*((*kernel).currentThread)).tickets;
+    (*((*kernel).currentThread)).tickets = 10;
+    (*share_lock).Acquire();
+    Thread * waiter = new Thread("E1");
+    (*waiter).tickets = 500;
+    (*waiter).Fork((VoidFunctionPtr)test_lock_waiter, (void *)0);
+    while ((*((*kernel).currentThread)).getTickets() == 10) {
+        (*((*kernel).currentThread)).Yield();	// let E1 block on the lock
+    }
+    cout << "main holds the lock, and " << (*((*kernel).currentThread)).getTickets() << " tickets while E1 waits." << endl;
+    (*share_lock).Release();
+    cout << "main released the lock, and holds " << (*((*kernel).currentThread)).getTickets() << " tickets." << endl;
+    (*jobs_done).P();
+    (*((*kernel).currentThread)).tickets = main_tickets;
+
+    delete share_lock;
+    share_lock = NULL;
+    delete jobs_done;
+    jobs_done = NULL;
+}
+
+//Parameters for testing_function_5(): each real-time thread runs
+//number_of_periods jobs, of job_units units of work each.
+static const int number_of_periods = 6;
+
+//My self-defined testing-related function: void test_periodic_job(int job_units)
+//Run as a real-time thread, doing job_units units of work every period.
+//A thread that does more work than its budget will miss its deadlines.
+void test_periodic_job(int job_units) {
+    Thread * thre = (*kernel).currentThread;
+    for (int j = 0; j < number_of_periods; j++) {
+        int release = (*thre).rtRelease;
+        for (int k = 0; k < job_units; k++) {
+            (*((*kernel).interrupt)).OneTick();
+        }
+        cout << (*thre).getName() << ": job " << j << " released at tick " << release << ", due at " << (*thre).rtAbsDeadline << ", done at " << (*((*kernel).stats)).totalTicks << "." << endl;
+        (*((*kernel).alarm)).WaitNextPeriod();
+    }
+    (*jobs_done).V();
+}
+
+//My self-defined testing-related function: void testing_function_5()
+//Real-time (EDF) check: R1 and R2 get a period of 3 timer periods, a
+//deadline of 2 and a budget of 50 ticks.  R1 keeps to its budget, so it
+//should meet every deadline even though the batch job F1 wants the CPU;
+//R2 does five times as much work, and misses.  Then R4 asks for more
+//utilization than R3 has left, and is turned away.
+void Thread::testing_function_5() {
+    jobs_done = new Semaphore("jobs done", 0);
+
+    Thread * batch = new Thread("F1");
+    (*batch).Fork((VoidFunctionPtr)test_long_job, (void *)200);
+    Thread * r1 = new Thread("R1");
+    ASSERT((*((*kernel).scheduler)).AdmitRealTime(r1, 3 * TimerTicks, 2 * TimerTicks, 50));
+    (*r1).Fork((VoidFunctionPtr)test_periodic_job, (void *)5);
+    for (int j = 0; j < 2; j++) {
+        (*jobs_done).P();
+    }
+    cout << "Deadline misses after R1: " << (*((*kernel).stats)).numDeadlineMisses << endl;
+
+    Thread * r2 = new Thread("R2");
+    ASSERT((*((*kernel).scheduler)).AdmitRealTime(r2, 3 * TimerTicks, 2 * TimerTicks, 50));
+    (*r2).Fork((VoidFunctionPtr)test_periodic_job, (void *)25);
+    (*jobs_done).P();
+    cout << "Deadline misses after R2: " << (*((*kernel).stats)).numDeadlineMisses << endl;
+
+    //R1 and R2 are finished, so there is room for R3 to ask for a
+    //utilization of 3/4, but then none for R4 to ask for 1/2.
+    Thread * r3 = new Thread("R3");
+    Thread * r4 = new Thread("R4");
+    bool r3_admitted = (*((*kernel).scheduler)).AdmitRealTime(r3, 4 * TimerTicks, 4 * TimerTicks, 3 * TimerTicks);
+    bool r4_admitted = (*((*kernel).scheduler)).AdmitRealTime(r4, 4 * TimerTicks, 2 * TimerTicks, TimerTicks);
+    cout << "R3 admitted: " << r3_admitted << ", R4 admitted: " << r4_admitted << endl;
+    IntStatus oldLevel = (*((*kernel).interrupt)).SetLevel(IntOff);
+    if (r3_admitted) { (*((*kernel).scheduler)).LeaveRealTime(r3); }
+    if (r4_admitted) { (*((*kernel).scheduler)).LeaveRealTime(r4); }
+    (*((*kernel).interrupt)).SetLevel(oldLevel);
+    delete r3;
+    delete r4;
+
+    delete jobs_done;
+    jobs_done = NULL;
+}
+
+//Locks and parameters for testing_function_6(): L holds lock A for a
+//critical section of inversion_section units of work, while M1 and M2
+//each want inversion_medium units.
+static Lock * inversion_lock_a = NULL;
+static Lock * inversion_lock_b = NULL;
+static Semaphore * inversion_step = NULL;
+static const int inversion_section = 50;
+static const int inversion_medium = 200;
+static int inversion_waited = 0;
+
+//My self-defined testing-related function: void test_inversion_low(int unused)
+//Take lock A, and work through a long critical section holding it.
+void test_inversion_low(int unused) {
+    (*inversion_lock_a).Acquire();
+    (*inversion_step).V();
+    for (int k = 0; k < inversion_section; k++) {
+        (*((*kernel).interrupt)).OneTick();
+    }
+    cout << "L releases lock A at tick " << (*((*kernel).stats)).totalTicks << "." << endl;
+    (*inversion_lock_a).Release();
+    (*jobs_done).V();
+}
+
+//My self-defined testing-related function: void test_inversion_middle(int unused)
+//Take lock B, then wait for lock A, which L holds.
+void test_inversion_middle(int unused) {
+    (*inversion_lock_b).Acquire();
+    (*inversion_step).V();
+    (*inversion_lock_a).Acquire();
+    cout << "X got lock A at tick " << (*((*kernel).stats)).totalTicks << "." << endl;
+    (*inversion_lock_a).Release();
+    (*inversion_lock_b).Release();
+    (*jobs_done).V();
+}
+
+//My self-defined testing-related function: void test_inversion_high(int unused)
+//Wait for lock B, which X holds while it waits for L.
+void test_inversion_high(int unused) {
+    int asked = (*((*kernel).stats)).totalTicks;
+    cout << "H asks for lock B at tick " << asked << "." << endl;
+    (*inversion_lock_b).Acquire();
+    inversion_waited = (*((*kernel).stats)).totalTicks - asked;
+    cout << "H got lock B at tick " << (*((*kernel).stats)).totalTicks << ", after waiting " << inversion_waited << " ticks." << endl;
+    (*inversion_lock_b).Release();
+    (*jobs_done).V();
+}
+
+//Set by testing_function_6(), so that M1 can report on it.
+static Thread * inversion_low = NULL;
+
+//My self-defined testing-related function: void test_inversion_medium(int unused)
+//Keep the CPU busy, without touching any lock.
+void test_inversion_medium(int unused) {
+    Thread * thre = (*kernel).currentThread;
+    cout << (*thre).getName() << " starts at tick " << (*((*kernel).stats)).totalTicks << "; L runs at priority " << (*inversion_low).effectivePriority << "." << endl;
+    for (int k = 0; k < inversion_medium; k++) {
+        (*((*kernel).interrupt)).OneTick();
+    }
+    cout << (*thre).getName() << " done at tick " << (*((*kernel).stats)).totalTicks << "." << endl;
+    (*jobs_done).V();
+}
+
+//My self-defined testing-related function: void testing_function_6()
+//Priority inversion check, under Priority scheduling: L (priority 9)
+//holds lock A; X (priority 7) holds lock B and waits for A; then H
+//(priority 1) waits for B, while M1 and M2 (priority 5) want the CPU.
+//Without priority inheritance, M1 and M2 would keep L (and so X and H)
+//off the CPU until they were done.  With it, H's priority is lent
+//through X to L, which finishes its critical section alongside M1 and
+//M2, so H waits about two of L's critical sections, not M1's and M2's
+//combined work.
+void Thread::testing_function_6() {
+    char * array_of_names[2] = {"M1", "M2"};
+
+    jobs_done = new Semaphore("jobs done", 0);
+    inversion_step = new Semaphore("inversion step", 0);
+    inversion_lock_a = new Lock("lock A");
+    inversion_lock_b = new Lock("lock B");
+
+    inversion_low = new Thread("L");
+    (*inversion_low).set_priority(9);
+    (*inversion_low).Fork((VoidFunctionPtr)test_inversion_low, (void *)0);
+    (*inversion_step).P();
+    Thread * middle = new Thread("X");
+    (*middle).set_priority(7);
+    (*middle).Fork((VoidFunctionPtr)test_inversion_middle, (void *)0);
+    (*inversion_step).P();
+    cout << "X waits for lock A; L runs at priority " << (*inversion_low).effectivePriority << "." << endl;
+
+    for (int j = 0; j < 2; j++) {
+        Thread * medium = new Thread(array_of_names[j]);
+        (*medium).set_priority(5);
+        (*medium).Fork((VoidFunctionPtr)test_inversion_medium, (void *)0);
+    }
+    Thread * high = new Thread("H");
+    (*high).set_priority(1);
+    (*high).Fork((VoidFunctionPtr)test_inversion_high, (void *)0);
+    for (int j = 0; j < 5; j++) {
+        (*jobs_done).P();
+    }
+    cout << "H waited " << inversion_waited << " ticks; L's critical section is " << inversion_section * SystemTick << " ticks of work, M1's and M2's " << 2 * inversion_medium * SystemTick << "." << endl;
+    //H waits for what is left of L's section, then X's turn with lock A:
+    //well under three sections, where M1's and M2's work would be eight.
+    if ((*((*kernel).scheduler)).get_scheduler_type() == Priority) {
+        ASSERT(inversion_waited <= 3 * inversion_section * SystemTick);
+    }
+
+    delete inversion_lock_a;
+    delete inversion_lock_b;
+    delete inversion_step;
+    delete jobs_done;
+    inversion_lock_a = inversion_lock_b = NULL;
+    inversion_step = NULL;
+    inversion_low = NULL;
+    jobs_done = NULL;
+}
@@ -40,12 +40,18 @@
 #include "copyright.h"
 #include "utility.h"
 #include "sysdep.h"
+#include "list.h"
+#include "dlist.h"
+#include "slab.h"
+#include "stats.h"
 
 #ifdef USER_PROGRAM
 #include "machine.h"
 #include "addrspace.h"
 #endif
 
+class Lock;
+
 // CPU register state to be saved on context switch.  
 // The x86 needs to save only a few registers, 
 // SPARC and MIPS needs to save 10 registers, 
@@ -60,6 +66,18 @@
 // WATCH OUT IF THIS ISN'T BIG ENOUGH!!!!!
 const int StackSize = (4 * 1024);	// in words
 
+// How many stacks of finished threads are kept for new threads to
+// reuse, rather than being given back to the host.
+const int StackPoolSize = 16;
+
+// Tickets a thread starts out with, for lottery and stride scheduling.
+const int DefaultTickets = 100;
+
+// Range of thread priorities; a smaller priority is scheduled first.
+// (CFS treats the priority as a nice value, and clamps it to -20 .. 19.)
+const int MinPriority = -64;
+const int MaxPriority = 63;
+
 
 // Thread state
 enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED };
@@ -89,6 +107,9 @@ class Thread {
 					// NOTE -- thread being deleted
 					// must not be running when delete 
 					// is called
+    void *operator new(size_t size) { return cache.Alloc(size); }
+    void operator delete(void *p) { cache.Free(p); }
+    static SlabCache cache;		// where threads are allocated from
 
     // basic thread operations
 
@@ -103,6 +124,7 @@ class Thread {
     
     void CheckOverflow();   	// Check if thread stack has overflowed
     void setStatus(ThreadStatus st) { status = st; }
+    ThreadStatus getStatus() { return status; }
     char* getName() { return (name); }
     void Print() { cout << name; }
     void SelfTest();		// test whether thread impl is working
@@ -113,6 +135,65 @@ class Thread {
     int priority_of_the_thread;
     int predicted_burst_time_of_the_thread;
 
+    // Bookkeeping for the multilevel feedback queue scheduler.
+    int mlfqLevel;		// which MLFQ ready queue we belong to
+    int readyTime;		// when we were last put on the ready list
+    int dispatchTime;		// when we were last given the CPU
+    int numDispatches;		// how many times we were given the CPU
+    int agedTime;		// when MLFQ aging last moved us up
+    int blockedTime;		// when we last blocked
+
+    ThreadStatistics *accounting;	// our CPU accounting, kept in
+					// kernel->stats
+    int quantumStart;		// when our current MLFQ quantum began
+    int burstTicks;		// CPU time used so far in the current
+				// burst, before we were last preempted
+    int readyKey;		// what SJF and SRTF ordered us by when
+				// we were last put on the ready heap
+    int readySeq;		// how many threads were put there
+				// before us; breaks ties between keys
+
+    DLink<Thread> queueLink;	// our place on the ready queue, or on
+				// the queue of a Semaphore, Lock or
+				// Condition we wait on; we are on at
+				// most one of them at a time
+
+    // Bookkeeping for Alarm::WaitUntil.
+    int wakeTime;		// period at which we are due to wake up
+    Thread *sleepNext;		// next thread in the same TimingWheel slot
+
+    // Bookkeeping for the completely fair scheduler; Stride uses
+    // vruntime as the thread's "pass".
+    int vruntime;		// CPU time used, scaled by our weight
+    int weight;			// our weight when last put on the ready list
+
+    // Lottery and stride scheduling: our share of the CPU is our
+    // tickets over the total tickets of all runnable threads.
+    int tickets;		// tickets we own
+    int donatedTickets;		// tickets lent to us by threads waiting
+				// for a Lock we hold
+    int getTickets() { return tickets + donatedTickets; }
+
+    // Priority inheritance: while a thread with a better priority
+    // waits for a Lock we hold -- or for a lock held by a thread
+    // waiting for one of ours, and so on -- we run at its priority.
+    int effectivePriority;	// what Priority scheduling goes by:
+				// priority_of_the_thread, or better
+    Lock *waitingFor;		// lock we are blocked on in Acquire
+    Lock *locksHeld;		// first of the locks we hold, linked
+				// through Lock::nextHeld
+
+    // Real-time (EDF) class.  A thread admitted by
+    // Scheduler::AdmitRealTime releases a job every rtPeriod ticks,
+    // and each job should be done rtDeadline ticks after its release.
+    int rtPeriod;		// 0 if we are not a real-time thread
+    int rtDeadline;		// relative deadline of each job
+    int rtBudget;		// CPU time each job needs, at most
+    int rtRelease;		// when the current job was released
+    int rtAbsDeadline;		// when the current job is due
+    bool rtWaiting;		// waiting for our next release?
+    bool rtMissed;		// has the current job missed its deadline?
+
 
     //Some functions that I need for setting some thread-related values.
     void set_start_time(int start_time_);
@@ -122,6 +203,10 @@ class Thread {
 
     static void testing_function_1();
     static void testing_function_2();
+    static void testing_function_3();
+    static void testing_function_4();
+    static void testing_function_5();
+    static void testing_function_6();
 
   private:
     // some of the private data for this class is listed above
@@ -146,11 +231,19 @@ class Thread {
   public:
     void SaveUserState();		// save user-level register state
     void RestoreUserState();		// restore user-level register state
+    bool ClaimUserContext();		// make the machine ours, saving
+					// the user state of whoever had
+					// it; TRUE if it was still ours
 
     AddrSpace *space;			// User code this thread is running.
 #endif
 };
 
+// A queue of threads, linked through their queueLink, such as a ready
+// queue or the threads waiting on a semaphore.
+
+typedef DList<Thread, &Thread::queueLink> ThreadQueue;
+
 // external function, dummy routine whose sole job is to call Thread::Print
 extern void ThreadPrint(Thread *thread);	 
 
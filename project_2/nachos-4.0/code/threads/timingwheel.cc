@@ -0,0 +1,252 @@
+// timingwheel.cc
+//	Routines to manage a hierarchical timing wheel of sleeping
+//	threads.  See timingwheel.h for details.
+//
+//	NOTE: Mutual exclusion must be provided by the caller; the
+//	alarm always calls us with interrupts disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "main.h"
+#include "timingwheel.h"
+
+//----------------------------------------------------------------------
+// TimingWheel::TimingWheel
+// 	Initialize a timing wheel, empty to start with.
+//
+//	"now" is the current period.
+//----------------------------------------------------------------------
+
+TimingWheel::TimingWheel(int now)
+{
+    for (int level = 0; level < WheelLevels; level++) {
+	for (int i = 0; i < WheelSlots; i++) {
+	    first[level][i] = last[level][i] = NULL;
+	}
+    }
+    current = now;
+    numInWheel = 0;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::~TimingWheel
+// 	Prepare a timing wheel for deallocation.  The threads still on
+//	it are not ours to de-allocate, but they are unlinked.  (When
+//	Nachos halts, threads may still be asleep.)
+//----------------------------------------------------------------------
+
+TimingWheel::~TimingWheel()
+{
+    Thread *thread, *next;
+
+    for (int level = 0; level < WheelLevels; level++) {
+	for (int i = 0; i < WheelSlots; i++) {
+	    for (thread = first[level][i]; thread != NULL; thread = next) {
+		next = thread->sleepNext;
+		thread->sleepNext = NULL;
+	    }
+	    first[level][i] = last[level][i] = NULL;
+	}
+    }
+    numInWheel = 0;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Insert
+//      Put "thread" on the wheel, to be woken up at period "when".
+//	A thread that is already due is woken up by the next Advance.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Insert(Thread *thread, int when)
+{
+    thread->wakeTime = (when > current) ? when : current + 1;
+    Place(thread);
+    numInWheel++;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Place
+//      Put "thread" at the end of its slot: the one on the lowest level
+//	whose slots still reach its wakeup period, from where we are now.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Place(Thread *thread)
+{
+    int when = thread->wakeTime;
+    int delta = when - current;
+    int level, slot;
+
+    for (level = 0; level < WheelLevels - 1; level++) {
+	if (delta < (1 << (WheelBits * (level + 1)))) {
+	    break;
+	}
+    }
+    if (level == WheelLevels - 1
+	    && delta >= (1 << (WheelBits * WheelLevels)) - WheelSlots) {
+	// too far out: park it in the furthest slot, it will be
+	// cascaded back here until it is due
+	when = current + (1 << (WheelBits * WheelLevels)) - WheelSlots;
+    }
+    slot = (delta <= 0) ? (current & WheelMask)
+		       : ((when >> (WheelBits * level)) & WheelMask);
+
+    thread->sleepNext = NULL;
+    if (first[level][slot] == NULL) {
+	first[level][slot] = thread;
+    } else {
+	last[level][slot]->sleepNext = thread;
+    }
+    last[level][slot] = thread;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Cascade
+//      The slot index of the level below "level" has just wrapped
+//	around: take everything out of the current slot of "level" and
+//	put it back on the wheel, where it now lands on a lower level.
+//	The level above goes first, since it may have wrapped too.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Cascade(int level)
+{
+    int slot = (current >> (WheelBits * level)) & WheelMask;
+    Thread *thread, *next;
+
+    if (slot == 0 && level + 1 < WheelLevels) {
+	Cascade(level + 1);
+    }
+    thread = first[level][slot];
+    first[level][slot] = last[level][slot] = NULL;
+    for (; thread != NULL; thread = next) {
+	next = thread->sleepNext;
+	Place(thread);
+    }
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Advance
+//      Move the wheel on, one period at a time, to period "now", and
+//	take off every thread whose wakeup period has come.  If the
+//	wheel is empty, just jump.
+//
+// Returns:
+//	The threads that are due, linked through sleepNext; NULL if none.
+//----------------------------------------------------------------------
+
+Thread *
+TimingWheel::Advance(int now)
+{
+    Thread *due = NULL, *dueLast = NULL;
+
+    while (current < now) {
+	if (numInWheel == 0) {
+	    current = now;
+	    break;
+	}
+	current++;
+	if ((current & WheelMask) == 0) {
+	    Cascade(1);
+	}
+
+	int slot = current & WheelMask;
+	if (first[0][slot] != NULL) {
+	    if (due == NULL) {
+		due = first[0][slot];
+	    } else {
+		dueLast->sleepNext = first[0][slot];
+	    }
+	    dueLast = last[0][slot];
+	    for (Thread *t = first[0][slot]; t != NULL; t = t->sleepNext) {
+		ASSERT(t->wakeTime <= current);
+		numInWheel--;
+	    }
+	    first[0][slot] = last[0][slot] = NULL;
+	}
+    }
+    return due;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::NextExpiry
+//      Return the next period at which Advance has something to do:
+//	either a thread on level 0 is due, or a slot of a higher level
+//	has to be cascaded (which brings its threads closer).  Looking
+//	at most at one lap of each level is enough.
+//
+//	Every level has to be looked at: a thread waiting on level 1
+//	can be cascaded, and then be due, before the first thread on
+//	level 0 (it went on the wheel earlier, when it was further out).
+//	So take the earliest of each level's first candidate.
+//
+// Returns:
+//	The period, or -1 if the wheel is empty.
+//----------------------------------------------------------------------
+
+int
+TimingWheel::NextExpiry()
+{
+    int next = -1;
+
+    if (numInWheel == 0) {
+	return -1;
+    }
+    for (int i = 1; i <= WheelSlots; i++) {
+	if (first[0][(current + i) & WheelMask] != NULL) {
+	    next = current + i;
+	    break;
+	}
+    }
+    for (int level = 1; level < WheelLevels; level++) {
+	int shift = WheelBits * level;
+	int base = current >> shift;
+
+	for (int i = 1; i <= WheelSlots; i++) {
+	    if (first[level][(base + i) & WheelMask] != NULL) {
+		if (next == -1 || ((base + i) << shift) < next) {
+		    next = (base + i) << shift;
+		}
+		break;
+	    }
+	}
+    }
+    ASSERT(next != -1);
+    return next;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::SelfTest
+//      Test whether this module is working, on an empty wheel that
+//	starts at period 0.  A thread is put on level 1, then, once the
+//	wheel has moved on, one that is due later goes on level 0; the
+//	level 1 thread must still come first.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::SelfTest()
+{
+    Thread *early = new Thread("wheel early");
+    Thread *late = new Thread("wheel late");
+
+    ASSERT(IsEmpty() && current == 0 && NextExpiry() == -1);
+    Insert(early, 70);			// level 1, slot 1
+    ASSERT(Advance(50) == NULL);
+    Insert(late, 110);			// level 0, slot 46
+    ASSERT(NextExpiry() == 64);		// early is cascaded at 64...
+    ASSERT(Advance(64) == NULL);
+    ASSERT(NextExpiry() == 70);		// ...and due at 70
+    ASSERT(Advance(100) == early && early->sleepNext == NULL);
+    ASSERT(NextExpiry() == 110);
+    ASSERT(Advance(110) == late && IsEmpty());
+
+    kernel->stats->DropThread(early->accounting);	// never ran; keep them
+    kernel->stats->DropThread(late->accounting);	// out of the table
+    delete early;
+    delete late;
+}
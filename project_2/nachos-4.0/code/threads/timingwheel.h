@@ -0,0 +1,72 @@
+// timingwheel.h
+//	Data structures for a hierarchical timing wheel, which keeps the
+//	threads sleeping in Alarm::WaitUntil ordered by when they are
+//	due to wake up.
+//
+//	Time is counted in "periods" (one period is TimerTicks).  Level 0
+//	has one slot per period, for the next WheelSlots periods; each
+//	level above has slots WheelSlots times as wide.  A thread goes in
+//	the slot of the lowest level that reaches its wakeup period, so
+//	putting it on the wheel is O(1).  As time moves on, each time a
+//	level's slot index wraps around, the next slot of the level above
+//	is emptied out ("cascaded") into the levels below.  A thread is
+//	cascaded at most once per level, so taking threads off the wheel
+//	is O(1) amortized, and a timer interrupt with nobody due only
+//	looks at one slot, rather than at every sleeping thread.
+//
+//	The links are kept in the Thread itself (a sleeping thread is on
+//	no other queue), so no memory is allocated on insert.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include "copyright.h"
+#include "thread.h"
+
+// Shape of the wheel: WheelLevels levels of WheelSlots slots each,
+// covering WheelSlots ^ WheelLevels periods.  Threads due later than
+// that are kept in the last slot that reaches, and cascaded until due.
+
+const int WheelBits = 6;
+const int WheelSlots = 1 << WheelBits;
+const int WheelMask = WheelSlots - 1;
+const int WheelLevels = 4;
+
+// The following class defines a timing wheel of sleeping threads.
+
+class TimingWheel {
+  public:
+    TimingWheel(int now);	// initialize an empty wheel; "now" is
+				// the current period
+    ~TimingWheel();		// de-allocate the wheel
+
+    void Insert(Thread *thread, int when);
+				// wake thread up at period "when"
+    Thread *Advance(int now);	// move the wheel on to period "now";
+				// return the threads that are due,
+				// linked through sleepNext, in the
+				// order they went on the wheel
+    int NextExpiry();		// the next period at which Advance
+				// has work to do; -1 if wheel is empty
+    bool IsEmpty() { return numInWheel == 0; }
+    int NumInWheel() { return numInWheel; }
+
+    void SelfTest();		// test whether the wheel is working;
+				// it must be new, at period 0
+
+  private:
+    Thread *first[WheelLevels][WheelSlots];	// head of each slot
+    Thread *last[WheelLevels][WheelSlots];	// tail of each slot
+    int current;		// the last period we advanced to
+    int numInWheel;		// total number of sleeping threads
+
+    void Place(Thread *thread);	// put thread in its slot
+    void Cascade(int level);	// empty out the current slot of
+				// "level" into the levels below
+};
+
+#endif // TIMINGWHEEL_H
@@ -52,10 +52,17 @@ static void SwapHeader (NoffHeader *noffH)
 
 bool AddrSpace::pages_being_used[NumPhysPages] = {0};
 
+// Page tables come from a slab cache, each with room for the most
+// pages a program can have (all of physical memory).
+static SlabCache pageTables("page table",
+			    NumPhysPages * sizeof(TranslationEntry), 4);
+
 AddrSpace::AddrSpace()
 {
 // zero out the entire address space
 //    bzero(kernel->machine->mainMemory, MemorySize);
+    pageTable = NULL;		// until Load
+    numPages = 0;
 }
 
 //----------------------------------------------------------------------
@@ -69,7 +76,7 @@ AddrSpace::~AddrSpace()
         unsigned int page_index = pageTable[k].physicalPage;
         AddrSpace::pages_being_used[page_index] = 0;
     }
-    delete pageTable;
+    pageTables.Free(pageTable);
 }
 
 
@@ -104,7 +111,8 @@ bool AddrSpace::Load(char *fileName)
 						// to leave room for the stack
     numPages = divRoundUp(size, PageSize);
 
-    pageTable = new TranslationEntry[numPages];
+    pageTable = (TranslationEntry *)
+		pageTables.Alloc(numPages * sizeof(TranslationEntry));
     for (unsigned int i = 0, s = 0; i < numPages; i++) {
 	    pageTable[i].virtualPage = i;	// for now, virt page # = phys page #
         while(AddrSpace::pages_being_used[s] != 0) {
@@ -169,8 +177,14 @@ void AddrSpace::Execute(char *fileName)
     }
 
     //kernel->currentThread->space = this;
+    // once we own the machine, our state must be in it before we can
+    // be preempted: the next user thread saves whatever it finds there
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    (void) kernel->currentThread->ClaimUserContext();
+					// save whoever was using the machine
     this->InitRegisters();		// set the initial register values
     this->RestoreState();		// load page table register
+    (void) kernel->interrupt->SetLevel(oldLevel);
 
     kernel->machine->Run();		// jump to the user progam
 
@@ -24,6 +24,7 @@
 #include "copyright.h"
 #include "main.h"
 #include "syscall.h"
+#include "futex.h"
 using namespace std;
 
 //----------------------------------------------------------------------
@@ -74,6 +75,44 @@ void ExceptionHandler(ExceptionType which)
 					cout << "Print integer:" <<val << endl;
 					return;
 
+				case SC_SetTickets:
+					val = kernel->machine->ReadRegister(4);
+					if (val <= 0) {
+						cerr << "SetTickets: tickets must be positive, got " << val << "\n";
+						kernel->machine->WriteRegister(2, -1);
+						return;
+					}
+					DEBUG(dbgThread, "SetTickets: " << kernel->currentThread->getName() << " now holds " << val << " tickets");
+					kernel->machine->WriteRegister(2, kernel->currentThread->tickets);
+					kernel->currentThread->tickets = val;
+					return;
+
+				case SC_SemCreate:
+					val = kernel->machine->ReadRegister(5);
+					if (val < 0 || !FutexTable::UserWordOK(
+					    kernel->machine->ReadRegister(4), TRUE)) {
+						kernel->machine->WriteRegister(2, -1);
+						return;
+					}
+					(void) kernel->machine->WriteMem(
+					    kernel->machine->ReadRegister(4), 4, val);
+					kernel->machine->WriteRegister(2, 0);
+					return;
+
+				case SC_FutexWait:	// contended SemWait
+					val = kernel->futexes->Wait(
+					    kernel->machine->ReadRegister(4),
+					    kernel->machine->ReadRegister(5));
+					kernel->machine->WriteRegister(2, val);
+					return;
+
+				case SC_FutexWake:	// SemSignal with waiters
+					val = kernel->futexes->Wake(
+					    kernel->machine->ReadRegister(4),
+					    kernel->machine->ReadRegister(5));
+					kernel->machine->WriteRegister(2, val);
+					return;
+
 		/*		case SC_Exec:
 					DEBUG(dbgAddr, "Exec\n");
 					val = kernel->machine->ReadRegister(4);
@@ -0,0 +1,265 @@
+// futex.cc
+//	Routines to block user threads on a word of their own memory,
+//	until some other thread wakes them.  See futex.h for details.
+//
+//	All of these are called from system calls, so the current
+//	thread is a user thread, and its page table is the one in the
+//	machine.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "futex.h"
+
+//----------------------------------------------------------------------
+// FutexTable::FutexTable
+//	Initialize the table, with no one waiting on anything.
+//----------------------------------------------------------------------
+
+FutexTable::FutexTable()
+{
+    for (int i = 0; i < NumFutexBuckets; i++) {
+	buckets[i] = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// FutexTable::~FutexTable
+//	De-allocate the table.  Threads still waiting when Nachos halts
+//	are never woken; their queues go with the table.
+//----------------------------------------------------------------------
+
+FutexTable::~FutexTable()
+{
+    for (int i = 0; i < NumFutexBuckets; i++) {
+	while (buckets[i] != NULL) {
+	    FutexQueue *queue = buckets[i];
+
+	    buckets[i] = queue->next;
+	    while (!queue->waiters.IsEmpty()) {
+		(void) queue->waiters.RemoveFront();
+	    }
+	    delete queue;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Find
+//	Look up the wait queue for a word.
+//
+// Returns:
+//	The link in its bucket that points to the queue -- or, if no
+//	one is waiting on the word, the NULL link at the end of the
+//	bucket, where a new queue can be put.
+//
+//	"space" is the address space the word is in.
+//	"addr" is its virtual address.
+//----------------------------------------------------------------------
+
+FutexQueue **
+FutexTable::Find(AddrSpace *space, int addr)
+{
+    FutexQueue **where = &buckets[((unsigned) addr >> 2) % NumFutexBuckets];
+
+    while (*where != NULL &&
+	    ((*where)->space != space || (*where)->addr != addr)) {
+	where = &(*where)->next;
+    }
+    return where;
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Wait
+//	Put the current thread to sleep on the word at "addr", unless
+//	it no longer holds "expected" -- that is, unless the thread
+//	that made the word worth waiting on has already changed it, and
+//	so may already have called Wake.
+//
+// Returns:
+//	0 if the thread slept and was woken, 1 if the word did not hold
+//	"expected", -1 if "addr" is not a word of the program's memory.
+//
+//	"addr" is the virtual address of the word.
+//	"expected" is the value the caller last saw there.
+//----------------------------------------------------------------------
+
+int
+FutexTable::Wait(int addr, int expected)
+{
+    Thread *thread = kernel->currentThread;
+    FutexQueue **where;
+    IntStatus oldLevel;
+    int value;
+
+    if (!UserWordOK(addr, FALSE)) {
+	return -1;
+    }
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    (void) kernel->machine->ReadMem(addr, 4, &value);
+    if (value != expected) {
+	(void) kernel->interrupt->SetLevel(oldLevel);
+	return 1;
+    }
+    where = Find(thread->space, addr);
+    if (*where == NULL) {
+	*where = new FutexQueue(thread->space, addr);
+    }
+    DEBUG(dbgThread, "FutexWait: " << thread->getName() << " on " << addr);
+    (*where)->waiters.Append(thread);
+    thread->Sleep(FALSE);
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// FutexTable::Wake
+//	Wake up to "count" of the threads sleeping on the word at "addr",
+//	in the order they went to sleep.
+//
+// Returns:
+//	How many threads were woken, or -1 if "addr" is not a word of
+//	the program's memory.
+//
+//	"addr" is the virtual address of the word.
+//	"count" is the most threads to wake.
+//----------------------------------------------------------------------
+
+int
+FutexTable::Wake(int addr, int count)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    FutexQueue **where, *queue;
+    IntStatus oldLevel;
+    Thread *thread;
+    int woken = 0;
+
+    if (!UserWordOK(addr, FALSE)) {
+	return -1;
+    }
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    where = Find(space, addr);
+    queue = *where;
+    if (queue != NULL) {
+	while (woken < count &&
+		(thread = queue->waiters.RemoveFront()) != NULL) {
+	    kernel->scheduler->ReadyToRun(thread);
+	    woken++;
+	}
+	if (queue->waiters.IsEmpty()) {
+	    *where = queue->next;
+	    delete queue;
+	}
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    DEBUG(dbgThread, "FutexWake: " << woken << " woken on " << addr);
+    return woken;
+}
+
+//----------------------------------------------------------------------
+// FutexTable::UserWordOK
+//	Check that the kernel can touch the current user program's word
+//	at "addr", so that ReadMem and WriteMem will not trap.
+//
+//	"addr" is the virtual address of the word.
+//	"writing" is TRUE if the kernel is going to store into it.
+//----------------------------------------------------------------------
+
+bool
+FutexTable::UserWordOK(int addr, bool writing)
+{
+    Machine *machine = kernel->machine;
+    unsigned int vpn = (unsigned) addr / PageSize;
+    TranslationEntry *entry;
+
+    if ((addr & 0x3) != 0 || machine->pageTable == NULL ||
+	    vpn >= machine->pageTableSize) {
+	return FALSE;
+    }
+    entry = &machine->pageTable[vpn];
+    return entry->valid && !(writing && entry->readOnly);
+}
+
+//----------------------------------------------------------------------
+// FutexWaiter
+//	One of FutexTable::SelfTest's threads: wait on the word at
+//	address 0 while it holds 0, and note the order we were woken in.
+//
+//	"which" is the thread's number
+//----------------------------------------------------------------------
+
+static int wakeOrder[2];
+static int numWoken;
+static Semaphore *waitersDone;
+
+static void
+FutexWaiter(int which)
+{
+    int result = kernel->futexes->Wait(0, 0);
+
+    ASSERT(result == 0);		// slept, and was woken
+    wakeOrder[numWoken++] = which;
+    waitersDone->V();
+}
+
+//----------------------------------------------------------------------
+// FutexTable::SelfTest
+//	Test the contended path: two threads wait on one word and are
+//	woken, one at a time, in the order they went to sleep.
+//
+//	User programs can only contend for a word if they share an
+//	address space, and no system call makes threads that do, so the
+//	test uses kernel threads.  They have no address space, so they
+//	all share the "space" NULL, and context switches between them
+//	leave the machine's page table alone.  It is pointed at a page
+//	table of our own, one page long, for the word to live in.
+//----------------------------------------------------------------------
+
+void
+FutexTable::SelfTest()
+{
+    Machine *machine = kernel->machine;
+    TranslationEntry page;
+    Thread *waiters[2];
+    int i;
+
+    ASSERT(machine->pageTable == NULL);
+    page.virtualPage = 0;
+    page.physicalPage = 0;
+    page.valid = TRUE;
+    page.use = page.dirty = page.readOnly = FALSE;
+    machine->pageTable = &page;
+    machine->pageTableSize = 1;
+    (void) machine->WriteMem(0, 4, 0);
+
+    ASSERT(Wait(0, 1) == 1);		// word is not 1: no sleep
+    ASSERT(Wake(0, 1) == 0);		// no one asleep
+    ASSERT(Wait(PageSize, 0) == -1);	// not a word of ours
+
+    numWoken = 0;
+    waitersDone = new Semaphore("futex waiters", 0);
+    for (i = 0; i < 2; i++) {		// each goes to sleep in turn
+	waiters[i] = new Thread("futex waiter");
+	waiters[i]->Fork((VoidFunctionPtr) FutexWaiter, (void *) i);
+	while (waiters[i]->getStatus() != BLOCKED) {
+	    kernel->currentThread->Yield();
+	}
+    }
+    ASSERT(*Find(NULL, 0) != NULL);
+
+    (void) machine->WriteMem(0, 4, 1);
+    ASSERT(Wake(0, 1) == 1);		// the first to sleep...
+    waitersDone->P();
+    ASSERT(numWoken == 1 && wakeOrder[0] == 0);
+    ASSERT(Wake(0, 5) == 1);		// ...then the other
+    waitersDone->P();
+    ASSERT(numWoken == 2 && wakeOrder[1] == 1);
+    ASSERT(*Find(NULL, 0) == NULL);	// queue went with its last waiter
+
+    delete waitersDone;
+    machine->pageTable = NULL;
+    machine->pageTableSize = 0;
+}
@@ -0,0 +1,76 @@
+// futex.h
+//	Data structures for blocking user threads on a word of their own
+//	memory -- "fast user-space mutexes", after the Linux system call.
+//
+//	User programs keep their semaphores and mutexes in their own
+//	memory, and take and release them with LL/SC, never trapping to
+//	the kernel while nobody has to wait.  Only a thread that finds
+//	the word taken calls FutexWait, to sleep until the holder calls
+//	FutexWake on the same word.
+//
+//	The kernel keeps nothing for a word no one is waiting on.  A
+//	wait queue is made the first time a thread waits on a word, and
+//	goes away when its last waiter is woken.
+//
+//	FutexWait only sleeps if the word still holds the value the
+//	caller last saw; the check and the sleep are done with
+//	interrupts off, so no other user thread can change the word (and
+//	call FutexWake, finding no one to wake) in between.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "copyright.h"
+#include "thread.h"
+
+class AddrSpace;
+
+// How many hash buckets the futex table has.
+const int NumFutexBuckets = 16;
+
+// The threads waiting on one word of one address space.
+
+class FutexQueue {
+  public:
+    FutexQueue(AddrSpace *s, int a) { space = s; addr = a; next = NULL; }
+
+    AddrSpace *space;		// whose memory the word is in
+    int addr;			// the word's virtual address
+    ThreadQueue waiters;	// threads asleep on it, in FIFO order
+    FutexQueue *next;		// next queue in the same bucket
+};
+
+// The following class defines the kernel's table of futex wait queues.
+
+class FutexTable {
+  public:
+    FutexTable();		// initialize the table, empty
+    ~FutexTable();		// de-allocate the table
+
+    int Wait(int addr, int expected);
+				// sleep on the current thread's word at
+				// addr, if it still holds expected
+    int Wake(int addr, int count);
+				// wake up to count threads sleeping on
+				// the word at addr
+
+    static bool UserWordOK(int addr, bool writing);
+				// can the kernel read (or write) the
+				// current user program's word at addr?
+
+    void SelfTest();		// test that waiters block and are woken;
+				// no user program may be running
+
+  private:
+    FutexQueue *buckets[NumFutexBuckets];
+
+    FutexQueue **Find(AddrSpace *space, int addr);
+				// where the queue for the word is, or
+				// would go if it has no waiters
+};
+
+#endif // FUTEX_H
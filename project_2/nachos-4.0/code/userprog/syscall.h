@@ -31,6 +31,10 @@
 #define SC_ThreadYield	10
 #define SC_PrintInt	11
 #define SC_Sleep	12
+#define SC_SetTickets	13
+#define SC_SemCreate	14
+#define SC_FutexWait	15
+#define SC_FutexWake	16
 
 #ifndef IN_ASM
 
@@ -130,8 +134,46 @@ void ThreadYield();
 
 void PrintInt(int number);	//my System Call
 
+/* Set the number of lottery/stride scheduling tickets the current thread
+ * holds (its share of the CPU, relative to the other threads).  Must be
+ * positive.  Returns the number of tickets it held before.
+ */
+int SetTickets(int tickets);
+
 void Sleep(int N); //Sleep function defined for project 2.
 
+/* Semaphores, for the threads of a user program to wait for each other.
+ * A semaphore is an int in the program's own memory, holding its count
+ * (-1 meaning 0, with threads perhaps waiting).  A mutex is a semaphore
+ * created with value 1.
+ *
+ * SemWait and SemSignal are not system calls: they change the count
+ * with LL/SC in user mode, and only trap to the kernel (FutexWait,
+ * FutexWake) when a thread has to wait, or has to be woken up.
+ */
+
+/* Set the semaphore at "sem" to "value", which must not be negative.
+ * Returns 0, or -1 if "sem" or "value" is bad.
+ */
+int SemCreate(int *sem, int value);
+
+/* Wait until the count is positive, then decrement it. */
+void SemWait(int *sem);
+
+/* Increment the count, waking up a waiting thread if there is one. */
+void SemSignal(int *sem);
+
+/* Sleep until woken by FutexWake on "addr" -- but only if *addr still
+ * holds "expected", so a wakeup cannot be missed.  Returns 0 once woken,
+ * 1 if *addr did not hold "expected", -1 if "addr" is bad.
+ */
+int FutexWait(int *addr, int expected);
+
+/* Wake up to "count" threads sleeping in FutexWait on "addr".  Returns
+ * how many were woken, or -1 if "addr" is bad.
+ */
+int FutexWake(int *addr, int count);
+
 
 #endif /* IN_ASM */
 
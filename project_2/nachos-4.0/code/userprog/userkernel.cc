@@ -10,6 +10,9 @@
 #include "synchconsole.h"
 #include "userkernel.h"
 #include "synchdisk.h"
+#ifdef FILESYS
+#include "bufcache.h"
+#endif // FILESYS
 
 //----------------------------------------------------------------------
 // UserProgKernel::UserProgKernel
@@ -21,11 +24,15 @@ UserProgKernel::UserProgKernel(int argc, char **argv)
 		: ThreadedKernel(argc, argv)
 {
     debugUserProg = FALSE;
+    syncDisk = FALSE;
 	execfileNum=0;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-s") == 0) {
 	    debugUserProg = TRUE;
 	}
+	else if (strcmp(argv[i], "-dsync") == 0) {
+	    syncDisk = TRUE;
+	}
 	else if (strcmp(argv[i], "-e") == 0) {
 		execfile[++execfileNum]= argv[++i];
 	}
@@ -34,10 +41,12 @@ UserProgKernel::UserProgKernel(int argc, char **argv)
 		cout << "Partial usage: nachos [-s]\n";
 		cout << "Partial usage: nachos [-u]" << endl;
 		cout << "Partial usage: nachos [-e] filename" << endl;
+		cout << "Partial usage: nachos [-dsync]" << endl;
 	}
 	else if (strcmp(argv[i], "-h") == 0) {
 		cout << "argument 's' is for debugging. Machine status  will be printed " << endl;
 		cout << "argument 'e' is for execting file." << endl;
+		cout << "argument 'dsync' puts each disk write on the host's disk as it is done." << endl;
 		cout << "atgument 'u' will print all argument usage." << endl;
 		cout << "For example:" << endl;
 		cout << "	./nachos -s : Print machine status during the machine is on." << endl;
@@ -64,10 +73,12 @@ UserProgKernel::Initialize(SchedulerType ty)
     ThreadedKernel::Initialize(ty);	// init multithreading
 
     machine = new Machine(debugUserProg);
-    fileSystem = new FileSystem();
 #ifdef FILESYS
-    synchDisk = new SynchDisk("New SynchDisk");
+    synchDisk = new SynchDisk("New SynchDisk", syncDisk);
+    bufferCache = new BufferCache(synchDisk);
 #endif // FILESYS
+    fileSystem = new FileSystem();	// uses the disk, if it is real
+    futexes = new FutexTable();
 }
 
 //----------------------------------------------------------------------
@@ -78,9 +89,11 @@ UserProgKernel::Initialize(SchedulerType ty)
 
 UserProgKernel::~UserProgKernel()
 {
+    delete futexes;
     delete fileSystem;
     delete machine;
 #ifdef FILESYS
+    delete bufferCache;		// writes back what is dirty
     delete synchDisk;
 #endif
 }
@@ -128,7 +141,12 @@ UserProgKernel::Run()
 //----------------------------------------------------------------------
 
 void
-UserProgKernel::SelfTest(bool var1, bool var2) {
+UserProgKernel::SelfTest(int testCase) {
+    futexes->SelfTest();		// test blocking on user memory
+#ifdef FILESYS
+    synchDisk->SelfTest();		// test the disk queue
+#endif // FILESYS
+
 /*    char ch;
 
     ThreadedKernel::SelfTest();
@@ -16,7 +16,9 @@
 #include "filesys.h"
 #include "machine.h"
 #include "synchdisk.h"
+#include "futex.h"
 class SynchDisk;
+class BufferCache;
 class UserProgKernel : public ThreadedKernel {
   public:
     UserProgKernel(int argc, char **argv);
@@ -28,18 +30,23 @@ class UserProgKernel : public ThreadedKernel {
 
     void Run();			// do kernel stuff 
 
-    void SelfTest(bool var1, bool var2);		// test whether kernel is working
+    void SelfTest(int testCase = 0);	// test whether kernel is working,
+					// then run TestCase<testCase>, if any
 
 // These are public for notational convenience.
     Machine *machine;
     FileSystem *fileSystem;
+    FutexTable *futexes;	// user threads blocked on their own memory
 
 #ifdef FILESYS
     SynchDisk *synchDisk;
+    BufferCache *bufferCache;	// file system's view of synchDisk
 #endif // FILESYS
 
   private:
     bool debugUserProg;		// single step user program
+    bool syncDisk;		// put each disk write on the host's disk
+				// as it is done
 	Thread* t[10];
 	char*	execfile[10];
 	int	execfileNum;